@@ -19,6 +19,14 @@
 
 #include "./threadpool/future.hpp"
 #include "./threadpool/pool.hpp"
+#include "./threadpool/task_group.hpp"
+#include "./threadpool/fork_join.hpp"
+#include "./threadpool/parallel_for.hpp"
+#include "./threadpool/parallel_reduce.hpp"
+#include "./threadpool/parallel_scan.hpp"
+#include "./threadpool/parallel_sort.hpp"
+#include "./threadpool/pipeline.hpp"
+#include "./threadpool/task_graph.hpp"
 
 #include "./threadpool/pool_adaptors.hpp"
 #include "./threadpool/task_adaptors.hpp"
@@ -0,0 +1,63 @@
+/*! \file
+* \brief Cache line padding.
+*
+* Members which are written frequently by different threads should not
+* share a cache line. cache_padded stretches its value to at least one
+* full cache line so that two padded members never interfere.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_CACHE_PADDED_HPP_INCLUDED
+#define THREADPOOL_DETAIL_CACHE_PADDED_HPP_INCLUDED
+
+#include <cstddef>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /// Assumed size of a cache line in bytes.
+  static std::size_t const cache_line_size = 64;
+
+
+  /*! \brief Value which occupies at least one cache line.
+  *
+  * \param T The type of the value.
+  */
+  template <typename T>
+  struct cache_padded
+  {
+    T value;    //!< The padded value.
+
+    /// Constructor.
+    cache_padded()
+      : value()
+    {
+    }
+
+    /*! Constructor.
+    * \param initial_value The argument the value is initialized with.
+    */
+    template <typename Arg>
+    explicit cache_padded(Arg const & initial_value)
+      : value(initial_value)
+    {
+    }
+
+  private:
+    char m_padding[cache_line_size - sizeof(T) % cache_line_size];
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_CACHE_PADDED_HPP_INCLUDED
@@ -0,0 +1,47 @@
+/*! \file
+* \brief Spin loop hint.
+*
+* This file contains a hint for the processor that the calling thread 
+* is busy waiting. On x86 it emits the pause instruction which saves
+* power and frees resources for the sibling hyper-thread.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_CPU_RELAX_HPP_INCLUDED
+#define THREADPOOL_DETAIL_CPU_RELAX_HPP_INCLUDED
+
+#include <boost/config.hpp>
+
+#if defined(BOOST_MSVC) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /// Tells the processor that the current thread is spinning.
+  inline void cpu_relax()
+  {
+#if defined(BOOST_MSVC) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __asm__ __volatile__("pause" ::: "memory");
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
+  }
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_CPU_RELAX_HPP_INCLUDED
@@ -19,6 +19,7 @@
 
 
 #include "locking_ptr.hpp"
+#include "worker_context.hpp"
 
 #include <boost/smart_ptr.hpp>
 #include <boost/optional.hpp>
@@ -70,6 +71,12 @@ public:
   void wait() const volatile
   {
     const future_type* self = const_cast<const future_type*>(this);
+    if(worker_context* const worker = worker_context::current())
+    {
+      self->help_until_ready(*worker, 0);
+      return;
+    }
+
     mutex::scoped_lock lock(self->m_monitor);
 
     while(!m_ready)
@@ -82,6 +89,11 @@ public:
   bool timed_wait(boost::xtime const & timestamp) const
   {
     const future_type* self = const_cast<const future_type*>(this);
+    if(worker_context* const worker = worker_context::current())
+    {
+      return self->help_until_ready(*worker, &timestamp);
+    }
+
     mutex::scoped_lock lock(self->m_monitor);
 
     while(!m_ready)
@@ -93,6 +105,33 @@ public:
   }
 
 
+  // Executes pending tasks of the worker's pool until the result is ready.
+  bool help_until_ready(worker_context & worker, boost::xtime const * const timestamp) const
+  {
+    mutex::scoped_lock lock(m_monitor);
+    while(!m_ready)
+    {
+      lock.unlock();
+      bool const executed = worker.execute_pending_task();
+      lock.lock();
+
+      if(executed || m_ready)
+      {
+        continue;
+      }
+
+      // no task available, wait for the result but look for new tasks regularly
+      boost::xtime const until = next_help_time(timestamp);
+      if(!m_condition_ready.timed_wait(lock, until) && timestamp && xtime_cmp(until, *timestamp) >= 0)
+      {
+        return m_ready;
+      }
+    }
+
+    return true;
+  }
+
+
   result_type operator()() const volatile
   {
     wait();
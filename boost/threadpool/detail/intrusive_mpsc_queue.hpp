@@ -0,0 +1,170 @@
+/*! \file
+* \brief Intrusive lock-free queue.
+*
+* This file contains an unbounded intrusive multi-producer single-consumer
+* queue based on Dmitry Vyukov's algorithm. The queue links nodes which are
+* owned by the caller and never allocates memory.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_INTRUSIVE_MPSC_QUEUE_HPP_INCLUDED
+#define THREADPOOL_DETAIL_INTRUSIVE_MPSC_QUEUE_HPP_INCLUDED
+
+
+#include "cache_padded.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/utility.hpp>
+
+#include <cstddef>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Link of an intrusive_mpsc_queue.
+  *
+  * A copied node is not linked, assigning a node does not change its link.
+  */
+  class intrusive_queue_node
+  {
+    friend class intrusive_mpsc_queue;
+
+    atomic<intrusive_queue_node*> m_next;
+
+  public:
+    /// Constructor.
+    intrusive_queue_node()
+      : m_next(0)
+    {
+    }
+
+    /// Copy constructor. The new node is not linked.
+    intrusive_queue_node(intrusive_queue_node const &)
+      : m_next(0)
+    {
+    }
+
+    /// Assignment. The link is not copied.
+    intrusive_queue_node & operator=(intrusive_queue_node const &)
+    {
+      return *this;
+    }
+  };
+
+
+  /*! \brief Intrusive lock-free multi-producer single-consumer queue.
+  *
+  * Producers append a node with a single atomic exchange and never wait.
+  * The consumer end is a plain pointer, so pop() must not be called
+  * concurrently. A stub node which belongs to the queue keeps the list
+  * non-empty. The queue does not own the nodes; a node must stay valid
+  * and must not be pushed again until it has been popped.
+  */
+  class intrusive_mpsc_queue
+  : private noncopyable
+  {
+    intrusive_queue_node                              m_stub;
+    cache_padded<atomic<intrusive_queue_node*> >      m_head;   // The most recently pushed node, used by producers.
+    cache_padded<intrusive_queue_node*>               m_tail;   // The next node to pop, used by the consumer.
+    cache_padded<atomic<std::size_t> >                m_size;
+
+  public:
+    /// Constructor.
+    intrusive_mpsc_queue()
+      : m_head(&m_stub)
+      , m_tail(&m_stub)
+      , m_size(0)
+    {
+    }
+
+
+    /*! Appends a node. May be called by any thread.
+    * \param node The node, which must not be linked.
+    */
+    void push(intrusive_queue_node & node)
+    {
+      m_size.value.fetch_add(1, memory_order_relaxed);
+      link(node);
+    }
+
+
+    /*! Removes the oldest node. Must not be called concurrently.
+    * \return The node or null if the queue is empty or the oldest node is being pushed.
+    */
+    intrusive_queue_node* pop()
+    {
+      intrusive_queue_node* tail = m_tail.value;
+      intrusive_queue_node* next = tail->m_next.load(memory_order_acquire);
+      if(tail == &m_stub)
+      {
+        if(!next)
+        {
+          return 0;
+        }
+        m_tail.value = next;
+        tail = next;
+        next = next->m_next.load(memory_order_acquire);
+      }
+
+      if(!next)
+      {
+        if(tail != m_head.value.load(memory_order_acquire))
+        {
+          return 0; // a producer has not linked its node yet
+        }
+
+        // the tail is the last node, append the stub to unlink it
+        link(m_stub);
+        next = tail->m_next.load(memory_order_acquire);
+        if(!next)
+        {
+          return 0;
+        }
+      }
+
+      m_tail.value = next;
+      m_size.value.fetch_sub(1, memory_order_relaxed);
+      return tail;
+    }
+
+
+    /*! Gets the number of nodes. The result is only a snapshot if other threads modify the queue.
+    *  \return The number of nodes, including nodes whose push has not completed.
+    */
+    std::size_t size() const
+    {
+      return m_size.value.load(memory_order_relaxed);
+    }
+
+
+    /*! Checks if the queue is empty. The result is only a snapshot if other threads modify the queue.
+    *  \return true if the queue contains no nodes, false otherwise.
+    */
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+  private:
+    void link(intrusive_queue_node & node)
+    {
+      node.m_next.store(0, memory_order_relaxed);
+      intrusive_queue_node* const previous = m_head.value.exchange(&node, memory_order_acq_rel);
+      previous->m_next.store(&node, memory_order_release);
+    }
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_INTRUSIVE_MPSC_QUEUE_HPP_INCLUDED
@@ -0,0 +1,335 @@
+/*! \file
+* \brief Bounded lock-free queue.
+*
+* This file contains a bounded multi-producer multi-consumer queue
+* based on Dmitry Vyukov's ring buffer with per-slot sequence numbers.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_MPMC_RING_BUFFER_HPP_INCLUDED
+#define THREADPOOL_DETAIL_MPMC_RING_BUFFER_HPP_INCLUDED
+
+
+#include "cache_padded.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/utility.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <new>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Bounded lock-free multi-producer multi-consumer queue.
+  *
+  * Each slot carries a sequence number which tells producers and consumers
+  * whether the slot is free or holds a value for the current lap. Producers
+  * and consumers only contend on their own index, so pushing and popping
+  * proceed in parallel. The items need not be DefaultConstructible.
+  *
+  * If an item's constructor throws, the claimed slot is published empty
+  * and consumers skip it, so the queue remains usable.
+  *
+  * \param T The type of the items.
+  */
+  template <typename T>
+  class mpmc_ring_buffer
+  : private noncopyable
+  {
+    /// Slot of the circular buffer.
+    struct cell
+    {
+      atomic<std::size_t>                                             m_sequence;
+      bool                                                            m_constructed;  // False if the item's constructor threw.
+      typename aligned_storage<sizeof(T), alignment_of<T>::value>::type m_storage;
+
+      T* item()
+      {
+        return static_cast<T*>(static_cast<void*>(&m_storage));
+      }
+    };
+
+    cell* const                           m_cells;
+    std::size_t const                     m_mask;
+    cache_padded<atomic<std::size_t> >    m_enqueue_position;
+    cache_padded<atomic<std::size_t> >    m_dequeue_position;
+
+  public:
+    /*! Constructor.
+    * \param capacity The maximum number of items, must be a power of two and at least two.
+    */
+    explicit mpmc_ring_buffer(std::size_t const capacity)
+      : m_cells(new cell[capacity])
+      , m_mask(capacity - 1)
+      , m_enqueue_position(0)
+      , m_dequeue_position(0)
+    {
+      assert(capacity >= 2 && (capacity & m_mask) == 0);
+      for(std::size_t i = 0; i < capacity; ++i)
+      {
+        m_cells[i].m_sequence.store(i, memory_order_relaxed);
+      }
+    }
+
+
+    /// Destructor. Remaining items are destructed.
+    ~mpmc_ring_buffer()
+    {
+      clear();
+      delete[] m_cells;
+    }
+
+
+    /*! Gets the maximum number of items.
+    *  \return The capacity.
+    */
+    std::size_t capacity() const
+    {
+      return m_mask + 1;
+    }
+
+
+    /*! Adds an item. May be called by any thread.
+    * \param value The item.
+    * \return true, if the item was added and false if the queue is full.
+    */
+    bool push(T const & value)
+    {
+      std::size_t position;
+      cell* const target = claim_back(position);
+      if(!target)
+      {
+        return false;
+      }
+
+      try
+      {
+        new(target->item()) T(value);
+      }
+      catch(...)
+      {
+        publish(target, position, false);
+        throw;
+      }
+      publish(target, position, true);
+      return true;
+    }
+
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds an item by moving it into the queue. May be called by any thread.
+    * \param value The item. It is left unchanged if the queue is full.
+    * \return true, if the item was added and false if the queue is full.
+    */
+    bool push(T && value)
+    {
+      std::size_t position;
+      cell* const target = claim_back(position);
+      if(!target)
+      {
+        return false;
+      }
+
+      try
+      {
+        new(target->item()) T(boost::move(value));
+      }
+      catch(...)
+      {
+        publish(target, position, false);
+        throw;
+      }
+      publish(target, position, true);
+      return true;
+    }
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs an item in place. May be called by any thread.
+    * \param args The arguments of the item's constructor. They are not used if the queue is full.
+    * \return true, if the item was added and false if the queue is full.
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      std::size_t position;
+      cell* const target = claim_back(position);
+      if(!target)
+      {
+        return false;
+      }
+
+      try
+      {
+        new(target->item()) T(std::forward<Args>(args)...);
+      }
+      catch(...)
+      {
+        publish(target, position, false);
+        throw;
+      }
+      publish(target, position, true);
+      return true;
+    }
+#endif
+
+
+    /*! Removes the oldest item. May be called by any thread.
+    * \param value Receives the item.
+    * \return true, if an item was removed and false if the queue is empty.
+    */
+    bool pop(T & value)
+    {
+      std::size_t position;
+      cell* source;
+      for(;;)
+      {
+        source = claim_front(position);
+        if(!source)
+        {
+          return false;
+        }
+        if(source->m_constructed)
+        {
+          break;
+        }
+        release_front(source, position); // skip the slot of a failed push
+      }
+
+      try
+      {
+        value = boost::move(*source->item());
+      }
+      catch(...)
+      {
+        release_front(source, position);
+        throw;
+      }
+      release_front(source, position);
+      return true;
+    }
+
+
+    /*! Gets the number of items. The result is only a snapshot if other threads modify the queue.
+    *  \return The number of items.
+    */
+    std::size_t size() const
+    {
+      std::size_t const dequeue_position = m_dequeue_position.value.load(memory_order_relaxed);
+      std::size_t const enqueue_position = m_enqueue_position.value.load(memory_order_relaxed);
+      std::ptrdiff_t const difference = static_cast<std::ptrdiff_t>(enqueue_position - dequeue_position);
+      return difference > 0 ? static_cast<std::size_t>(difference) : 0;
+    }
+
+
+    /*! Checks if the queue is empty. The result is only a snapshot if other threads modify the queue.
+    *  \return true if the queue contains no items, false otherwise.
+    */
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+
+    /*! Removes and destructs all items.
+    */
+    void clear()
+    {
+      std::size_t position;
+      while(cell* const source = claim_front(position))
+      {
+        release_front(source, position);
+      }
+    }
+
+  private:
+    cell* claim_back(std::size_t & position)
+    {
+      position = m_enqueue_position.value.load(memory_order_relaxed);
+      for(;;)
+      {
+        cell* const target = &m_cells[position & m_mask];
+        std::size_t const sequence = target->m_sequence.load(memory_order_acquire);
+        std::ptrdiff_t const difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if(difference == 0)
+        {
+          if(m_enqueue_position.value.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+          {
+            return target;
+          }
+        }
+        else if(difference < 0)
+        {
+          return 0; // full
+        }
+        else
+        {
+          position = m_enqueue_position.value.load(memory_order_relaxed);
+        }
+      }
+    }
+
+    cell* claim_front(std::size_t & position)
+    {
+      position = m_dequeue_position.value.load(memory_order_relaxed);
+      for(;;)
+      {
+        cell* const source = &m_cells[position & m_mask];
+        std::size_t const sequence = source->m_sequence.load(memory_order_acquire);
+        std::ptrdiff_t const difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+        if(difference == 0)
+        {
+          if(m_dequeue_position.value.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+          {
+            return source;
+          }
+        }
+        else if(difference < 0)
+        {
+          return 0; // empty
+        }
+        else
+        {
+          position = m_dequeue_position.value.load(memory_order_relaxed);
+        }
+      }
+    }
+
+    // Makes a claimed slot visible to consumers. An empty slot is skipped by them.
+    void publish(cell* const target, std::size_t const position, bool const constructed)
+    {
+      target->m_constructed = constructed;
+      target->m_sequence.store(position + 1, memory_order_release);
+    }
+
+    void release_front(cell* const source, std::size_t const position)
+    {
+      if(source->m_constructed)
+      {
+        source->item()->~T();
+      }
+      source->m_sequence.store(position + m_mask + 1, memory_order_release);
+    }
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_MPMC_RING_BUFFER_HPP_INCLUDED
@@ -25,20 +25,32 @@
 
 
 
+#include "cache_padded.hpp"
 #include "locking_ptr.hpp"
+#include "thread_affinity.hpp"
+#include "worker_context.hpp"
 #include "worker_thread.hpp"
 
+#include "../intrusive_task.hpp"
+#include "../scheduler_traits.hpp"
 #include "../task_adaptors.hpp"
+#include "../unique_task.hpp"
 
+#include <boost/atomic.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/exceptions.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/smart_ptr.hpp>
 #include <boost/bind.hpp>
+#include <boost/mpl/and.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/move/iterator.hpp>
+#include <boost/move/utility_core.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits.hpp>
 
+#include <utility>
 #include <vector>
 
 
@@ -46,6 +58,107 @@
 namespace boost { namespace threadpool { namespace detail 
 {
 
+  /// Checks if a task may be called. Empty function objects are skipped by the pool.
+  template <typename Task>
+  inline bool is_valid_task(Task const &)
+  {
+    return true;
+  }
+
+  inline bool is_valid_task(function0<void> const & task)
+  {
+    return !task.empty();
+  }
+
+  inline bool is_valid_task(intrusive_task const & task)
+  {
+    return !task.empty();
+  }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  template <std::size_t InlineCapacity>
+  inline bool is_valid_task(basic_unique_task<InlineCapacity> const & task)
+  {
+    return !task.empty();
+  }
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  /// Constructs a task in place in a scheduler which provides emplace().
+  template <typename Scheduler, typename... Args>
+  inline bool emplace_task(Scheduler & scheduler, mpl::true_, Args &&... args)
+  {
+    return scheduler.emplace(std::forward<Args>(args)...);
+  }
+
+  /// Constructs a temporary task and moves it into a scheduler which does not provide emplace().
+  template <typename Scheduler, typename... Args>
+  inline bool emplace_task(Scheduler & scheduler, mpl::false_, Args &&... args)
+  {
+    return scheduler.push(typename Scheduler::task_type(std::forward<Args>(args)...));
+  }
+#endif
+
+
+  /// Feeds the tasks of an iterator range into a scheduler.
+  template <typename InputIterator>
+  class task_range_source
+  {
+    InputIterator m_first;
+    InputIterator m_last;
+
+  public:
+    task_range_source(InputIterator const & first, InputIterator const & last)
+      : m_first(first)
+      , m_last(last)
+    {
+    }
+
+    /// Pushes the next task. Returns false if the range is exhausted or the scheduler refused the task.
+    template <typename Scheduler>
+    bool push_next(Scheduler & scheduler)
+    {
+      if(m_first == m_last || !scheduler.push(*m_first))
+      {
+        return false;
+      }
+      ++m_first;
+      return true;
+    }
+  };
+
+
+  /// Feeds the tasks f(0), f(1), ..., f(count - 1) into a scheduler.
+  template <typename Generator>
+  class task_generator_source
+  {
+    Generator   m_generator;
+    std::size_t m_index;
+    std::size_t m_count;
+
+  public:
+    task_generator_source(std::size_t const count, Generator const & generator)
+      : m_generator(generator)
+      , m_index(0)
+      , m_count(count)
+    {
+    }
+
+    /// Pushes the next task. Returns false if all tasks were generated or the scheduler refused the task.
+    template <typename Scheduler>
+    bool push_next(Scheduler & scheduler)
+    {
+      if(m_index == m_count || !scheduler.push(m_generator(m_index)))
+      {
+        return false;
+      }
+      ++m_index;
+      return true;
+    }
+  };
+
+
   /*! \brief Thread pool. 
   *
   * Thread pools are a mechanism for asynchronous and parallel processing 
@@ -57,12 +170,13 @@ namespace boost { namespace threadpool { namespace detail
   * A pool_impl is DefaultConstructible and NonCopyable.
   *
   * \param Task A function object which implements the operator 'void operator() (void) const'. The operator () is called by the pool to execute the task. Exceptions are ignored.
-  * \param Scheduler A task container which determines how tasks are scheduled. It is guaranteed that this container is accessed only by one thread at a time. The scheduler shall not throw exceptions.
+  * \param Scheduler A task container which determines how tasks are scheduled. It is guaranteed that this container is accessed only by one thread at a time unless it is a concurrent scheduler. The scheduler shall not throw exceptions.
+  * \param IdlePolicy Determines what a worker does before it blocks because no task is available. Each worker owns an instance.
   *
   * \remarks The pool class is thread-safe.
   * 
   * \see Tasks: task_func, prio_task_func
-  * \see Scheduling policies: fifo_scheduler, lifo_scheduler, prio_scheduler
+  * \see Scheduling policies: fifo_scheduler, lifo_scheduler, prio_scheduler, bounded_fifo_scheduler, work_stealing_scheduler
   */ 
   template <
     typename Task, 
@@ -70,10 +184,11 @@ namespace boost { namespace threadpool { namespace detail
     template <typename> class SchedulingPolicy,
     template <typename> class SizePolicy,
     template <typename> class SizePolicyController,
-    template <typename> class ShutdownPolicy
+    template <typename> class ShutdownPolicy,
+    template <typename> class IdlePolicy
   > 
   class pool_core
-  : public enable_shared_from_this< pool_core<Task, SchedulingPolicy, SizePolicy, SizePolicyController, ShutdownPolicy > > 
+  : public enable_shared_from_this< pool_core<Task, SchedulingPolicy, SizePolicy, SizePolicyController, ShutdownPolicy, IdlePolicy > > 
   , private noncopyable
   {
 
@@ -84,7 +199,8 @@ namespace boost { namespace threadpool { namespace detail
                       SchedulingPolicy, 
                       SizePolicy,
                       SizePolicyController,
-                      ShutdownPolicy > pool_type;           //!< Indicates the thread pool's type.
+                      ShutdownPolicy,
+                      IdlePolicy > pool_type;               //!< Indicates the thread pool's type.
     typedef SizePolicy<pool_type> size_policy_type;         //!< Indicates the sizer's type.
     //typedef typename size_policy_type::size_controller size_controller_type;
 
@@ -92,9 +208,35 @@ namespace boost { namespace threadpool { namespace detail
 
 //    typedef SizePolicy<pool_type>::size_controller size_controller_type;
     typedef ShutdownPolicy<pool_type> shutdown_policy_type;//!< Indicates the shutdown policy's type.  
+    typedef IdlePolicy<pool_type> idle_policy_type;         //!< Indicates the idle policy's type.  
 
     typedef worker_thread<pool_type> worker_type;
 
+    /// Tasks which a worker took from a sequential scheduler at once. Each worker reuses its batch.
+    class task_batch
+    : private noncopyable
+    {
+      friend class pool_core;
+
+      std::vector<task_type>  m_tasks;
+      atomic<size_t>          m_remaining;  // Number of tasks which were not started yet. Claimed by the worker or by clear().
+      task_batch*             m_next;       // Link of the pool's list of batches in progress. Guarded by the task monitor.
+
+    public:
+      task_batch()
+        : m_remaining(0)
+        , m_next(0)
+      {
+      }
+    };
+
+    typedef typename mpl::bool_<is_concurrent_scheduler<scheduler_type>::value>::type scheduler_concurrency;
+    typedef typename mpl::and_<scheduler_concurrency, detail::has_worker_hooks<scheduler_type> >::type scheduler_worker_hooks;
+    typedef typename detail::has_task_pop<scheduler_type>::type scheduler_task_pop;
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    typedef typename detail::has_emplace<scheduler_type>::type scheduler_emplace;
+#endif
+
     // The task is required to be a nullary function.
     BOOST_STATIC_ASSERT(function_traits<task_type()>::arity == 0);
 
@@ -114,23 +256,65 @@ namespace boost { namespace threadpool { namespace detail
 #endif
 
   private: // The following members may be accessed by _multiple_ threads at the same time:
-    volatile size_t m_worker_count;	
-    volatile size_t m_target_worker_count;	
-    volatile size_t m_active_worker_count;
+    cache_padded<atomic<size_t> > m_worker_count;	
+    cache_padded<atomic<size_t> > m_target_worker_count;	
+    cache_padded<atomic<size_t> > m_active_worker_count;
+    cache_padded<atomic<size_t> > m_pending_task_count;     // Mirrors the scheduler's size. Used with sequential schedulers only.
+    cache_padded<atomic<size_t> > m_batched_task_count;     // Number of tasks which wait in the batches of workers.
+    cache_padded<atomic<size_t> > m_sleeping_worker_count;  // Number of workers which are blocked or about to block.
+    atomic<size_t>                m_dequeue_batch_size;     // Maximum number of tasks a worker takes from a sequential scheduler at once.
+    mutable atomic<size_t>        m_task_waiter_count;      // Number of threads blocked in wait(). Allows workers to skip the lock.
+    mutable atomic<size_t>        m_helping_worker_count;   // Number of workers which execute pending tasks in wait().
+    atomic<bool>                  m_terminate_all_workers;  // Indicates if termination of all workers was triggered. No tasks are accepted afterwards.
       
 
 
   private: // The following members are accessed only by _one_ thread at the same time:
-    scheduler_type  m_scheduler;
+    // A thread which is blocked until the number of tasks is equal or less than its threshold.
+    struct task_waiter
+    {
+      size_t const  threshold;
+      bool const    count_pending;  // If false only active tasks are counted.
+      bool const    count_helping;  // If false tasks whose worker helps in wait() are not counted.
+      condition     event;
+      task_waiter*  next;
+
+      task_waiter(size_t const task_threshold, bool const count_pending_tasks, bool const count_helping_workers = true)
+        : threshold(task_threshold)
+        , count_pending(count_pending_tasks)
+        , count_helping(count_helping_workers)
+        , next(0)
+      {
+      }
+    };
+
+    // A worker which is blocked because no task is available.
+    struct idle_worker
+    {
+      condition     event;
+      bool          woken;
+      idle_worker*  next;
+
+      idle_worker()
+        : woken(false)
+        , next(0)
+      {
+      }
+    };
+
+    scheduler_type  m_scheduler;  // Guarded by m_task_monitor unless the scheduler is concurrent.
+    task_batch* m_task_batches;           // Batches in progress. Guarded by m_task_monitor.
+    mutable task_waiter* m_task_waiters;  // Guarded by m_task_monitor.
+    idle_worker* m_idle_workers;          // Stack of blocked workers, the most recently blocked on top. Guarded by m_task_monitor.
     scoped_ptr<size_policy_type> m_size_policy; // is never null
     
-    bool  m_terminate_all_workers;								// Indicates if termination of all workers was triggered.
     std::vector<shared_ptr<worker_type> > m_terminated_workers; // List of workers which are terminated but not fully destructed.
+    std::vector<unsigned int> m_worker_cpus;  // Processors the workers are bound to, empty if the workers are not bound.
+    size_t  m_next_worker_cpu;                // Index of the processor the next started worker is bound to.
     
   private: // The following members are implemented thread-safe:
-    mutable recursive_mutex  m_monitor;
-    mutable condition m_worker_idle_or_terminated_event;	// A worker is idle or was terminated.
-    mutable condition m_task_or_terminate_workers_event;  // Task is available OR total worker count should be reduced.
+    mutable recursive_mutex  m_lifecycle_monitor;       // Guards resizing, shutdown and the worker list.
+    mutable mutex     m_task_monitor;                   // Guards the sequential scheduler and the idle state of the workers.
 
   public:
     /// Constructor.
@@ -138,7 +322,17 @@ namespace boost { namespace threadpool { namespace detail
       : m_worker_count(0) 
       , m_target_worker_count(0)
       , m_active_worker_count(0)
+      , m_pending_task_count(0)
+      , m_batched_task_count(0)
+      , m_sleeping_worker_count(0)
+      , m_dequeue_batch_size(1)
+      , m_task_waiter_count(0)
+      , m_helping_worker_count(0)
       , m_terminate_all_workers(false)
+      , m_task_batches(0)
+      , m_task_waiters(0)
+      , m_idle_workers(0)
+      , m_next_worker_cpu(0)
     {
       pool_type volatile & self_ref = *this;
       m_size_policy.reset(new size_policy_type(self_ref));
@@ -163,16 +357,59 @@ namespace boost { namespace threadpool { namespace detail
 
     /*! Gets the number of threads in the pool.
     * \return The number of threads.
+    * \remarks The function is wait-free.
     */
     size_t size()	const volatile
     {
-      return m_worker_count;
+      return m_worker_count.value.load(memory_order_relaxed);
     }
 
 // TODO is only called once
     void shutdown()
     {
-      ShutdownPolicy<pool_type>::shutdown(*this);
+      bool stopped;
+      {
+        recursive_mutex::scoped_lock lock(m_lifecycle_monitor);
+        stopped = m_terminate_all_workers;
+      }
+
+      if(stopped)
+      { // there are no workers which could complete the tasks
+        clear();
+        terminate_all_workers(true);
+      }
+      else
+      {
+        ShutdownPolicy<pool_type>::shutdown(*this);
+      }
+    }
+
+
+    /*! Terminates all workers. The active tasks are completed, the pending tasks are discarded.
+    *  Afterwards the pool cannot be resized any more and scheduling fails.
+    * \remarks Must not be called by a task of the pool.
+    */
+    void stop() volatile
+    {
+      {
+        recursive_mutex::scoped_lock lock(const_cast<pool_type*>(this)->m_lifecycle_monitor);
+        const_cast<pool_type*>(this)->m_terminate_all_workers.store(true);
+      }
+      clear();
+      terminate_all_workers(true);
+      clear();  // tasks which were pushed to a concurrent scheduler while the pool stopped
+    }
+
+
+    /*! Binds the workers which are started afterwards to the given processors.
+    *  The processors are assigned round-robin in the order the workers start.
+    * \param cpus The zero-based processor indices. An empty list disables binding.
+    */
+    void set_worker_cpus(std::vector<unsigned int> const & cpus) volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor); 
+      lockedThis->m_worker_cpus = cpus;
+      lockedThis->m_next_worker_cpu = 0;
     }
 
     /*! Schedules a task for asynchronous execution. The task will be executed once only.
@@ -181,36 +418,102 @@ namespace boost { namespace threadpool { namespace detail
     */  
     bool schedule(task_type const & task) volatile
     {	
-      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor); 
-      
-      if(lockedThis->m_scheduler.push(task))
-      {
-        lockedThis->m_task_or_terminate_workers_event.notify_one();
-        return true;
-      }
-      else
-      {
-        return false;
-      }
+      return schedule(task, scheduler_concurrency());
+    }	
+
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Schedules a task for asynchronous execution. The task is moved into the scheduler.
+    * \param task The task function object. It should not throw execeptions.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */  
+    bool schedule(task_type && task) volatile
+    {	
+      return schedule(boost::move(task), scheduler_concurrency());
+    }	
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a task in place in the scheduler and schedules it for asynchronous execution.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */  
+    template <typename... Args>
+    bool emplace(Args &&... args) volatile
+    {	
+      return emplace(scheduler_concurrency(), std::forward<Args>(args)...);
+    }	
+#endif
+
+
+    /*! Schedules the tasks of a range. The tasks are enqueued at once and 
+    *  at most as many idle workers are woken up as there are new tasks.
+    * \param first The first task of the range.
+    * \param last The end of the range.
+    * \return The number of scheduled tasks. The scheduling stops at the first task which cannot be scheduled.
+    */  
+    template <typename InputIterator>
+    size_t schedule_bulk(InputIterator first, InputIterator last) volatile
+    {	
+      task_range_source<InputIterator> source(first, last);
+      return schedule_batch(source, scheduler_concurrency());
+    }	
+
+
+    /*! Schedules the tasks generator(0), ..., generator(count - 1). The tasks are 
+    *  enqueued at once and at most count idle workers are woken up.
+    * \param count The number of tasks.
+    * \param generator A function object which is called with the index and returns the task.
+    * \return The number of scheduled tasks. The scheduling stops at the first task which cannot be scheduled.
+    */  
+    template <typename Generator>
+    size_t schedule_n(size_t const count, Generator generator) volatile
+    {	
+      task_generator_source<Generator> source(count, generator);
+      return schedule_batch(source, scheduler_concurrency());
     }	
 
 
+    /*! Sets the maximum number of tasks a worker removes from the scheduler 
+    *  with one lock acquisition. The batch adapts to the number of pending tasks,
+    *  a worker never takes more than its share of them.
+    * \param max_tasks The maximum batch size. 0 and 1 disable batching.
+    * \remarks Only schedulers which are accessed under the pool's lock are dequeued in batches.
+    *  Tasks in a batch remain pending until the worker starts them, clear() discards them.
+    */  
+    void set_dequeue_batch_size(size_t const max_tasks) volatile
+    {
+      m_dequeue_batch_size.store(max_tasks > 1 ? max_tasks : 1, memory_order_relaxed);
+    }
+
+
+    /*! Gets the maximum number of tasks a worker removes from the scheduler at once.
+    * \return The maximum batch size.
+    */  
+    size_t dequeue_batch_size() const volatile
+    {
+      return m_dequeue_batch_size.load(memory_order_relaxed);
+    }
+
+
     /*! Returns the number of tasks which are currently executed.
     * \return The number of active tasks. 
+    * \remarks The function is wait-free.
     */  
     size_t active() const volatile
     {
-      return m_active_worker_count;
+      return m_active_worker_count.value.load(memory_order_relaxed);
     }
 
 
     /*! Returns the number of tasks which are ready for execution.    
     * \return The number of pending tasks. 
+    * \remarks The function does not lock.
     */  
     size_t pending() const volatile
     {
-      locking_ptr<const pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-      return lockedThis->m_scheduler.size();
+      return pending(scheduler_concurrency());
     }
 
 
@@ -218,229 +521,963 @@ namespace boost { namespace threadpool { namespace detail
     */  
     void clear() volatile
     { 
-      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-      lockedThis->m_scheduler.clear();
+      clear(scheduler_concurrency());
     }    
 
 
     /*! Indicates that there are no tasks pending. 
     * \return true if there are no tasks ready for execution.	
-    * \remarks This function is more efficient that the check 'pending() == 0'.
+    * \remarks This function is more efficient that the check 'pending() == 0'. It does not lock.
     */   
     bool empty() const volatile
     {
-      locking_ptr<const pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-      return lockedThis->m_scheduler.empty();
+      return empty(scheduler_concurrency());
     }	
 
 
     /*! The current thread of execution is blocked until the sum of all active
     *  and pending tasks is equal or less than a given threshold. 
+    *  If the caller is a worker of the pool it executes pending tasks in the meantime.
+    *  Tasks which wait themselves are not counted then.
     * \param task_threshold The maximum number of tasks in pool and scheduler.
     */     
     void wait(size_t const task_threshold = 0) const volatile
     {
-      const pool_type* self = const_cast<const pool_type*>(this);
-      recursive_mutex::scoped_lock lock(self->m_monitor);
-
-      if(0 == task_threshold)
+      if(is_own_worker())
       {
-        while(0 != self->m_active_worker_count || !self->m_scheduler.empty())
-        { 
-          self->m_worker_idle_or_terminated_event.wait(lock);
-        }
-      }
-      else
-      {
-        while(task_threshold < self->m_active_worker_count + self->m_scheduler.size())
-        { 
-          self->m_worker_idle_or_terminated_event.wait(lock);
-        }
+        help_wait(task_threshold, 0);
+        return;
       }
+
+      const pool_type* self = const_cast<const pool_type*>(this);
+      mutex::scoped_lock lock(self->m_task_monitor);
+
+      task_waiter waiter(task_threshold, true);
+      wait_for_tasks(lock, waiter, 0);
     }	
 
     /*! The current thread of execution is blocked until the timestamp is met
     * or the sum of all active and pending tasks is equal or less 
     * than a given threshold.  
+    *  If the caller is a worker of the pool it executes pending tasks in the meantime.
+    *  Tasks which wait themselves are not counted then.
     * \param timestamp The time when function returns at the latest.
     * \param task_threshold The maximum number of tasks in pool and scheduler.
     * \return true if the task sum is equal or less than the threshold, false otherwise.
     */       
     bool wait(xtime const & timestamp, size_t const task_threshold = 0) const volatile
+    {
+      if(is_own_worker())
+      {
+        return help_wait(task_threshold, &timestamp);
+      }
+
+      const pool_type* self = const_cast<const pool_type*>(this);
+      mutex::scoped_lock lock(self->m_task_monitor);
+
+      task_waiter waiter(task_threshold, true);
+      return wait_for_tasks(lock, waiter, &timestamp);
+    }
+
+
+  private:	
+
+
+    // Checks if the current thread is a worker of this pool.
+    bool is_own_worker() const volatile
+    {
+      worker_context const * const worker = worker_context::current();
+      return worker && worker->pool() == this;
+    }
+
+
+    // Executes pending tasks until the threshold is met. Called by a worker of this pool.
+    bool help_wait(size_t const task_threshold, xtime const * const timestamp) const volatile
     {
       const pool_type* self = const_cast<const pool_type*>(this);
-      recursive_mutex::scoped_lock lock(self->m_monitor);
+      worker_context & worker = *worker_context::current();
 
-      if(0 == task_threshold)
+      // Tasks which wait do not count for each other, otherwise two of them would wait forever.
+      // A worker is counted once, even if a task it executes while helping waits again.
+      // Pairs with the registration in wait_for_tasks: either the waiter sees the increment or we see the waiter.
+      if(worker.enter_help())
       {
-        while(0 != self->m_active_worker_count || !self->m_scheduler.empty())
-        { 
-          if(!self->m_worker_idle_or_terminated_event.timed_wait(lock, timestamp)) return false;
+        self->m_helping_worker_count.fetch_add(1, memory_order_seq_cst);
+        if(self->m_task_waiter_count.load(memory_order_seq_cst) > 0)
+        {
+          mutex::scoped_lock lock(self->m_task_monitor);
+          notify_task_waiters();
         }
       }
-      else
+
+      try
       {
-        while(task_threshold < self->m_active_worker_count + self->m_scheduler.size())
-        { 
-          if(!self->m_worker_idle_or_terminated_event.timed_wait(lock, timestamp)) return false;
-        }
+        bool const result = help_until_threshold(task_threshold, timestamp);
+        leave_help(worker);
+        return result;
+      }
+      catch(...)
+      {
+        leave_help(worker);
+        throw;
       }
-
-      return true;
     }
 
 
-  private:	
+    void leave_help(worker_context & worker) const volatile
+    {
+      if(worker.leave_help())
+      {
+        const_cast<const pool_type*>(this)->m_helping_worker_count.fetch_sub(1, memory_order_seq_cst);
+      }
+    }
 
 
-    void terminate_all_workers(bool const wait) volatile
+    bool help_until_threshold(size_t const task_threshold, xtime const * const timestamp) const volatile
     {
       pool_type* self = const_cast<pool_type*>(this);
-      recursive_mutex::scoped_lock lock(self->m_monitor);
+      task_waiter waiter(task_threshold, true, false);
 
-      self->m_terminate_all_workers = true;
+      for(;;)
+      {
+        size_t const helping = self->m_helping_worker_count.load(memory_order_relaxed);
+        size_t const active_tasks = active();
+        size_t const pending_tasks = self->m_terminate_all_workers.load(memory_order_relaxed) ? 0 : pending();
+        if((active_tasks > helping ? active_tasks - helping : 0) + pending_tasks <= waiter.threshold)
+        {
+          return true;
+        }
 
-      m_target_worker_count = 0;
-      self->m_task_or_terminate_workers_event.notify_all();
+        if(self->execute_pending_task())
+        {
+          continue;
+        }
 
-      if(wait)
-      {
-        while(m_active_worker_count > 0)
+        // no task available, wait for the threshold but look for new tasks regularly
+        mutex::scoped_lock lock(self->m_task_monitor);
+        if(!self->m_scheduler.empty())
         {
-          self->m_worker_idle_or_terminated_event.wait(lock);
+          continue;
         }
 
-        for(typename std::vector<shared_ptr<worker_type> >::iterator it = self->m_terminated_workers.begin();
-          it != self->m_terminated_workers.end();
-          ++it)
+        xtime const until = next_help_time(timestamp);
+        if(wait_for_tasks(lock, waiter, &until))
         {
-          (*it)->join();
+          return true;
+        }
+        if(timestamp && xtime_cmp(until, *timestamp) >= 0)
+        {
+          return false;
         }
-        self->m_terminated_workers.clear();
       }
     }
 
 
-    /*! Changes the number of worker threads in the pool. The resizing 
-    *  is handled by the SizePolicy.
-    * \param threads The new number of worker threads.
-    * \return true, if pool will be resized and false if not. 
-    */
-    bool resize(size_t const worker_count) volatile
+    // Blocks until the waiter's threshold is met or the optional timestamp is reached. The task monitor must be locked.
+    bool wait_for_tasks(mutex::scoped_lock & lock, task_waiter & waiter, xtime const * const timestamp) const volatile
     {
-      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor); 
-
-      if(!m_terminate_all_workers)
+      if(is_below_threshold(waiter))
       {
-        m_target_worker_count = worker_count;
-      }
-      else
-      { 
-        return false;
+        return true;
       }
 
-
-      if(m_worker_count <= m_target_worker_count)
-      { // increase worker count
-        while(m_worker_count < m_target_worker_count)
+      add_task_waiter(waiter);
+      try
+      {
+        while(!is_below_threshold(waiter))
         {
-          try
+          if(!timestamp)
           {
-            worker_thread<pool_type>::create_and_attach(lockedThis->shared_from_this());
-            m_worker_count++;
-            m_active_worker_count++;	
+            waiter.event.wait(lock);
           }
-          catch(thread_resource_error)
+          else if(!waiter.event.timed_wait(lock, *timestamp))
           {
+            remove_task_waiter(waiter);
             return false;
           }
         }
       }
-      else
-      { // decrease worker count
-        lockedThis->m_task_or_terminate_workers_event.notify_all();   // TODO: Optimize number of notified workers
+      catch(...)
+      {
+        remove_task_waiter(waiter);
+        throw;
       }
-
+      remove_task_waiter(waiter);
       return true;
     }
 
 
-    // worker died with unhandled exception
-    void worker_died_unexpectedly(shared_ptr<worker_type> worker) volatile
+    // Checks if the number of tasks is equal or less than the waiter's threshold. The task monitor must be locked.
+    bool is_below_threshold(task_waiter const & waiter) const volatile
     {
-      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-
-      m_worker_count--;
-      m_active_worker_count--;
-      lockedThis->m_worker_idle_or_terminated_event.notify_all();	
-
-      if(m_terminate_all_workers)
+      const pool_type* self = const_cast<const pool_type*>(this);
+      size_t active_tasks = m_active_worker_count.value.load(memory_order_seq_cst);
+      if(!waiter.count_helping)
       {
-        lockedThis->m_terminated_workers.push_back(worker);
+        size_t const helping = self->m_helping_worker_count.load(memory_order_seq_cst);
+        active_tasks = active_tasks > helping ? active_tasks - helping : 0;
       }
-      else
+      size_t const pending_tasks = self->m_scheduler.size() + m_batched_task_count.value.load(memory_order_seq_cst);
+      bool const count_pending = waiter.count_pending && !self->m_terminate_all_workers.load(memory_order_relaxed);  // pending tasks never run after termination
+      size_t const tasks = active_tasks + (count_pending ? pending_tasks : 0);
+      return tasks <= waiter.threshold;
+    }
+
+
+    void add_task_waiter(task_waiter & waiter) const volatile
+    {
+      const pool_type* self = const_cast<const pool_type*>(this);
+      waiter.next = self->m_task_waiters;
+      self->m_task_waiters = &waiter;
+      self->m_task_waiter_count.fetch_add(1, memory_order_seq_cst);
+    }
+
+
+    void remove_task_waiter(task_waiter & waiter) const volatile
+    {
+      const pool_type* self = const_cast<const pool_type*>(this);
+      task_waiter** link = &self->m_task_waiters;
+      while(*link != &waiter)
       {
-        lockedThis->m_size_policy->worker_died_unexpectedly(m_worker_count);
+        link = &(*link)->next;
       }
+      *link = waiter.next;
+      self->m_task_waiter_count.fetch_sub(1, memory_order_relaxed);
     }
 
-    void worker_destructed(shared_ptr<worker_type> worker) volatile
-    {
-      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-      m_worker_count--;
-      m_active_worker_count--;
-      lockedThis->m_worker_idle_or_terminated_event.notify_all();	
 
-      if(m_terminate_all_workers)
+    // Wakes up the waiters whose threshold is met. The task monitor must be locked.
+    void notify_task_waiters() const volatile
+    {
+      for(task_waiter* waiter = const_cast<const pool_type*>(this)->m_task_waiters; waiter; waiter = waiter->next)
       {
-        lockedThis->m_terminated_workers.push_back(worker);
+        if(is_below_threshold(*waiter))
+        {
+          waiter->event.notify_one();
+        }
       }
     }
 
 
-    bool execute_task() volatile
+    // Wakes up the waiters whose threshold is met. Locks the task monitor only if there are waiters.
+    // Pairs with the registration in wait_for_tasks: either the waiter sees the removed task or we see the waiter.
+    void notify_task_waiters_if_any() const volatile
     {
-      function0<void> task;
+      const pool_type* self = const_cast<const pool_type*>(this);
+      atomic_thread_fence(memory_order_seq_cst);
+      if(self->m_task_waiter_count.load(memory_order_seq_cst) > 0)
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        notify_task_waiters();
+      }
+    }
 
-      { // fetch task
-        pool_type* lockedThis = const_cast<pool_type*>(this);
-        recursive_mutex::scoped_lock lock(lockedThis->m_monitor);
 
-        // decrease number of threads if necessary
-        if(m_worker_count > m_target_worker_count)
-        {	
-          return false;	// terminate worker
-        }
+    size_t pending(mpl::false_) const volatile
+    {
+      return m_pending_task_count.value.load(memory_order_relaxed) + m_batched_task_count.value.load(memory_order_relaxed);
+    }
 
+    size_t pending(mpl::true_) const volatile
+    {
+      return const_cast<const pool_type*>(this)->m_scheduler.size();
+    }
 
-        // wait for tasks
-        while(lockedThis->m_scheduler.empty())
-        {	
-          // decrease number of workers if necessary
-          if(m_worker_count > m_target_worker_count)
-          {	
-            return false;	// terminate worker
-          }
-          else
-          {
-            m_active_worker_count--;
-            lockedThis->m_worker_idle_or_terminated_event.notify_all();	
-            lockedThis->m_task_or_terminate_workers_event.wait(lock);
-            m_active_worker_count++;
-          }
-        }
 
-        task = lockedThis->m_scheduler.top();
-        lockedThis->m_scheduler.pop();
-      }
+    void clear(mpl::false_) volatile
+    { 
+      locking_ptr<pool_type, mutex> lockedThis(*this, m_task_monitor);
+      lockedThis->m_scheduler.clear();
+      m_pending_task_count.value.store(0, memory_order_relaxed);
 
-      // call task function
-      if(task)
+      // discard the tasks which workers took in batches but did not start yet
+      for(task_batch* batch = lockedThis->m_task_batches; batch; batch = batch->m_next)
       {
-        task();
+        m_batched_task_count.value.fetch_sub(batch->m_remaining.exchange(0, memory_order_relaxed), memory_order_relaxed);
       }
- 
-      //guard->disable();
+      notify_task_waiters();
+    }    
+
+    void clear(mpl::true_) volatile
+    { 
+      const_cast<pool_type*>(this)->m_scheduler.clear();
+      notify_task_waiters_if_any();
+    }    
+
+
+    bool empty(mpl::false_) const volatile
+    {
+      return pending(mpl::false_()) == 0;
+    }	
+
+    bool empty(mpl::true_) const volatile
+    {
+      return const_cast<const pool_type*>(this)->m_scheduler.empty();
+    }	
+
+
+    template <typename TaskArgument>
+    bool schedule(BOOST_FWD_REF(TaskArgument) task, mpl::false_) volatile
+    {	
+      locking_ptr<pool_type, mutex> lockedThis(*this, m_task_monitor); 
+      
+      if(!lockedThis->m_terminate_all_workers && lockedThis->m_scheduler.push(boost::forward<TaskArgument>(task)))
+      {
+        m_pending_task_count.value.store(lockedThis->m_scheduler.size(), memory_order_relaxed);
+        wake_worker();
+        return true;
+      }
+      else
+      {
+        return false;
+      }
+    }	
+
+
+    template <typename TaskArgument>
+    bool schedule(BOOST_FWD_REF(TaskArgument) task, mpl::true_) volatile
+    {	
+      pool_type* self = const_cast<pool_type*>(this);
+
+      if(self->m_terminate_all_workers || !self->m_scheduler.push(boost::forward<TaskArgument>(task)))
+      {
+        return false;
+      }
+
+      // Pairs with the fence in execute_task: either the sleeping worker sees the task or we see the worker.
+      atomic_thread_fence(memory_order_seq_cst);
+      if(self->m_sleeping_worker_count.value.load(memory_order_relaxed) > 0)
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        wake_worker();
+      }
+      return true;
+    }	
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    template <typename... Args>
+    bool emplace(mpl::false_, Args &&... args) volatile
+    {	
+      locking_ptr<pool_type, mutex> lockedThis(*this, m_task_monitor); 
+      
+      if(!lockedThis->m_terminate_all_workers && emplace_task(lockedThis->m_scheduler, scheduler_emplace(), std::forward<Args>(args)...))
+      {
+        m_pending_task_count.value.store(lockedThis->m_scheduler.size(), memory_order_relaxed);
+        wake_worker();
+        return true;
+      }
+      else
+      {
+        return false;
+      }
+    }	
+
+
+    template <typename... Args>
+    bool emplace(mpl::true_, Args &&... args) volatile
+    {	
+      pool_type* self = const_cast<pool_type*>(this);
+
+      if(self->m_terminate_all_workers || !emplace_task(self->m_scheduler, scheduler_emplace(), std::forward<Args>(args)...))
+      {
+        return false;
+      }
+
+      // Pairs with the fence in execute_task, see schedule().
+      atomic_thread_fence(memory_order_seq_cst);
+      if(self->m_sleeping_worker_count.value.load(memory_order_relaxed) > 0)
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        wake_worker();
+      }
+      return true;
+    }	
+#endif
+
+
+    template <typename Source>
+    size_t schedule_batch(Source & source, mpl::false_) volatile
+    {	
+      pool_type* self = const_cast<pool_type*>(this);
+      mutex::scoped_lock lock(self->m_task_monitor);
+      if(self->m_terminate_all_workers)
+      {
+        return 0;
+      }
+
+      size_t scheduled = 0;
+      while(source.push_next(self->m_scheduler))
+      {
+        ++scheduled;
+      }
+      m_pending_task_count.value.store(self->m_scheduler.size(), memory_order_relaxed);
+
+      wake_workers(scheduled);
+      return scheduled;
+    }	
+
+
+    template <typename Source>
+    size_t schedule_batch(Source & source, mpl::true_) volatile
+    {	
+      pool_type* self = const_cast<pool_type*>(this);
+      if(self->m_terminate_all_workers)
+      {
+        return 0;
+      }
+
+      size_t scheduled = 0;
+      while(source.push_next(self->m_scheduler))
+      {
+        ++scheduled;
+      }
+
+      // Pairs with the fence in execute_task, see schedule().
+      atomic_thread_fence(memory_order_seq_cst);
+      if(scheduled > 0 && self->m_sleeping_worker_count.value.load(memory_order_relaxed) > 0)
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        wake_workers(scheduled);
+      }
+      return scheduled;
+    }	
+
+
+    // Wakes up as many blocked workers as there are new tasks. The task monitor must be locked.
+    void wake_workers(size_t tasks) volatile
+    {
+      while(tasks-- > 0 && wake_worker())
+      {
+      }
+    }
+
+
+    // Wakes up the most recently blocked worker, its cache is most likely still warm. The task monitor must be locked.
+    bool wake_worker() volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      idle_worker* const worker = self->m_idle_workers;
+      if(!worker)
+      {
+        return false;
+      }
+
+      self->m_idle_workers = worker->next;
+      worker->woken = true;
+      worker->event.notify_one();
+      return true;
+    }
+
+
+    // Blocks the calling worker until it is woken up. The task monitor must be locked.
+    void park_worker(mutex::scoped_lock & lock) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      idle_worker worker;
+      worker.next = self->m_idle_workers;
+      self->m_idle_workers = &worker;
+
+      try
+      {
+        while(!worker.woken)
+        {
+          worker.event.wait(lock);
+        }
+      }
+      catch(...)
+      {
+        if(!worker.woken)
+        {
+          idle_worker** link = &self->m_idle_workers;
+          while(*link != &worker)
+          {
+            link = &(*link)->next;
+          }
+          *link = worker.next;
+        }
+        throw;
+      }
+    }
+
+
+    void terminate_all_workers(bool const wait) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+
+      {
+        recursive_mutex::scoped_lock lock(self->m_lifecycle_monitor);
+        self->m_terminate_all_workers = true;
+        self->m_target_worker_count.value.store(0);
+      }
+
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        while(wake_worker())
+        {
+        }
+
+        if(wait)
+        {
+          task_waiter waiter(0, false);
+          wait_for_tasks(lock, waiter, 0);
+        }
+      }
+
+      if(wait)
+      {
+        recursive_mutex::scoped_lock lock(self->m_lifecycle_monitor);
+
+        for(typename std::vector<shared_ptr<worker_type> >::iterator it = self->m_terminated_workers.begin();
+          it != self->m_terminated_workers.end();
+          ++it)
+        {
+          (*it)->join();
+        }
+        self->m_terminated_workers.clear();
+      }
+    }
+
+
+    /*! Changes the number of worker threads in the pool. The resizing 
+    *  is handled by the SizePolicy.
+    * \param threads The new number of worker threads.
+    * \return true, if pool will be resized and false if not. 
+    */
+    bool resize(size_t const worker_count) volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor); 
+
+      if(!lockedThis->m_terminate_all_workers)
+      {
+        m_target_worker_count.value.store(worker_count);
+      }
+      else
+      { 
+        return false;
+      }
+
+
+      if(size() <= worker_count)
+      { // increase worker count
+        while(size() < worker_count)
+        {
+          m_active_worker_count.value.fetch_add(1); // count the new worker as active before it can become idle
+
+          try
+          {
+            worker_thread<pool_type>::create_and_attach(lockedThis->shared_from_this());
+            m_worker_count.value.fetch_add(1);
+          }
+          catch(thread_resource_error)
+          {
+            worker_left_active_state();
+            return false;
+          }
+        }
+      }
+      else
+      { // decrease worker count, wake up as many blocked workers as are surplus
+        mutex::scoped_lock lock(lockedThis->m_task_monitor);
+        wake_workers(size() - worker_count);
+      }
+
+      return true;
+    }
+
+
+    void worker_started() volatile
+    {
+      bind_worker_to_cpu();
+      attach_worker(scheduler_worker_hooks());
+    }
+
+    void bind_worker_to_cpu() volatile
+    {
+      unsigned int cpu;
+      {
+        locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor); 
+        if(lockedThis->m_worker_cpus.empty())
+        {
+          return;
+        }
+        cpu = lockedThis->m_worker_cpus[lockedThis->m_next_worker_cpu++ % lockedThis->m_worker_cpus.size()];
+      }
+      bind_current_thread_to_cpu(cpu);
+    }
+
+    void attach_worker(mpl::false_) volatile
+    {
+    }
+
+    void attach_worker(mpl::true_) volatile
+    {
+      const_cast<pool_type*>(this)->m_scheduler.attach_worker();
+    }
+
+    void detach_worker(mpl::false_) volatile
+    {
+    }
+
+    void detach_worker(mpl::true_) volatile
+    {
+      const_cast<pool_type*>(this)->m_scheduler.detach_worker();
+    }
+
+
+    // Decreases the number of active workers and notifies waiting threads.
+    void worker_left_active_state() volatile
+    {
+      locking_ptr<pool_type, mutex> lockedThis(*this, m_task_monitor);
+      m_active_worker_count.value.fetch_sub(1, memory_order_relaxed);
+      notify_task_waiters();
+    }
+
+
+    // worker died with unhandled exception
+    void worker_died_unexpectedly(shared_ptr<worker_type> worker) volatile
+    {
+      detach_worker(scheduler_worker_hooks());
+
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor);
+
+      m_worker_count.value.fetch_sub(1);
+      worker_left_active_state();
+
+      if(lockedThis->m_terminate_all_workers)
+      {
+        lockedThis->m_terminated_workers.push_back(worker);
+      }
+      else
+      {
+        lockedThis->m_size_policy->worker_died_unexpectedly(size());
+      }
+    }
+
+    // worker left the pool, the worker count was already decreased by leave_pool
+    void worker_destructed(shared_ptr<worker_type> worker) volatile
+    {
+      detach_worker(scheduler_worker_hooks());
+
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor);
+      worker_left_active_state();
+
+      if(lockedThis->m_terminate_all_workers)
+      {
+        lockedThis->m_terminated_workers.push_back(worker);
+      }
+    }
+
+
+    // Indicates that there are more workers than requested.
+    bool has_surplus_workers() const volatile
+    {
+      return m_worker_count.value.load(memory_order_relaxed) > m_target_worker_count.value.load(memory_order_relaxed);
+    }
+
+
+    // Removes the calling worker from the worker count if there are too many workers.
+    bool leave_pool() volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_lifecycle_monitor);
+      if(has_surplus_workers())
+      {
+        m_worker_count.value.fetch_sub(1);
+        return true;
+      }
+      return false;
+    }
+
+
+    // Executes one pending task on behalf of a waiting worker.
+    bool execute_pending_task() volatile
+    {
+      return execute_pending_task(scheduler_concurrency());
+    }
+
+
+    bool execute_pending_task(mpl::false_) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      mutex::scoped_lock lock(self->m_task_monitor);
+      if(self->m_scheduler.empty())
+      {
+        return false;
+      }
+
+      task_type task;
+      pop_task(task, scheduler_task_pop());
+      m_pending_task_count.value.store(self->m_scheduler.size(), memory_order_relaxed);
+      notify_task_waiters();
+      lock.unlock();
+
+      if(is_valid_task(task))
+      {
+        task();
+      }
+      return true;
+    }
+
+
+    bool execute_pending_task(mpl::true_) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      task_type task;
+      if(!self->m_scheduler.try_pop(task))
+      {
+        return false;
+      }
+
+      notify_task_waiters_if_any();
+      if(is_valid_task(task))
+      {
+        task();
+      }
+      return true;
+    }
+
+
+    bool execute_task(idle_policy_type & idle_policy, task_batch & batch) volatile
+    {
+      return execute_task(idle_policy, batch, scheduler_concurrency());
+    }
+
+
+    bool execute_task(idle_policy_type & idle_policy, task_batch & batch, mpl::false_) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      task_type task;
+      bool batched = false;
+
+      for(;;)
+      {
+        // decrease number of threads if necessary
+        if(has_surplus_workers() && leave_pool())
+        {	
+          return false;	// terminate worker
+        }
+
+        // give the idle policy a chance to wait for a task without blocking
+        bool const keep_polling = m_pending_task_count.value.load(memory_order_relaxed) == 0 && !has_surplus_workers() && await_task(idle_policy);
+
+        // fetch task
+        mutex::scoped_lock lock(self->m_task_monitor);
+        if(!self->m_scheduler.empty())
+        {
+          size_t const batch_size = fair_batch_size(self->m_scheduler.size());
+          if(batch_size > 1)
+          { // the first task is active, the others remain pending until the worker starts them
+            batch.m_tasks.resize(batch_size);
+            for(typename std::vector<task_type>::iterator it = batch.m_tasks.begin(); it != batch.m_tasks.end(); ++it)
+            {
+              pop_task(*it, scheduler_task_pop());
+            }
+            batch.m_remaining.store(batch_size - 1, memory_order_relaxed);
+            m_batched_task_count.value.fetch_add(batch_size - 1, memory_order_relaxed);
+            batch.m_next = self->m_task_batches;
+            self->m_task_batches = &batch;
+            batched = true;
+          }
+          else
+          {
+            pop_task(task, scheduler_task_pop());
+          }
+          m_pending_task_count.value.store(self->m_scheduler.size(), memory_order_relaxed);
+          notify_task_waiters();
+          break;
+        }
+
+        // wait for tasks
+        if(!keep_polling && !has_surplus_workers())
+        {
+          m_active_worker_count.value.fetch_sub(1, memory_order_relaxed);
+          m_sleeping_worker_count.value.fetch_add(1, memory_order_relaxed);
+          notify_task_waiters();
+          park_worker(lock);
+          m_sleeping_worker_count.value.fetch_sub(1, memory_order_relaxed);
+          m_active_worker_count.value.fetch_add(1, memory_order_relaxed);
+        }
+      }
+
+      // call task function
+      if(batched)
+      {
+        execute_batch(batch);
+      }
+      else if(is_valid_task(task))
+      {
+        task();
+      }
+
+      //guard->disable();
+      return true;
+    }
+
+
+    // Removes the next task from a sequential scheduler which moves it out. The caller holds the task monitor.
+    void pop_task(task_type & task, mpl::true_) volatile
+    {
+      const_cast<pool_type*>(this)->m_scheduler.pop(task);
+    }
+
+
+    // Removes the next task from a sequential scheduler which only provides top().
+    void pop_task(task_type & task, mpl::false_) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      task = self->m_scheduler.top();
+      self->m_scheduler.pop();
+    }
+
+
+    // Lets the idle policy wait for a task. The worker is not counted as active in the meantime.
+    bool await_task(idle_policy_type & idle_policy) volatile
+    {
+      // Pairs with the registration in wait_for_tasks: either the waiter sees the decrement or we see the waiter.
+      m_active_worker_count.value.fetch_sub(1, memory_order_seq_cst);
+      const pool_type* self = const_cast<const pool_type*>(this);
+      if(self->m_task_waiter_count.load(memory_order_seq_cst) > 0)
+      {
+        mutex::scoped_lock lock(self->m_task_monitor);
+        notify_task_waiters();
+      }
+
+      bool const resume = idle_policy.await_task(*this);
+      m_active_worker_count.value.fetch_add(1, memory_order_relaxed);
+      return resume;
+    }
+
+
+    // Gets the number of tasks a worker should take if the given number of tasks is pending.
+    size_t fair_batch_size(size_t const pending_tasks) const volatile
+    {
+      size_t const workers = size();
+      size_t const share = workers > 1 ? pending_tasks / workers : pending_tasks;
+      size_t const limit = dequeue_batch_size();
+      return share < 1 ? 1 : (share < limit ? share : limit);
+    }
+
+
+    // Executes the tasks of a batch. If a task throws, the tasks which were not started are given back to the scheduler.
+    void execute_batch(task_batch & batch) volatile
+    {
+      size_t const count = batch.m_tasks.size();
+      size_t index = 0;
+      try
+      {
+        for(;;)
+        {
+          task_type & task = batch.m_tasks[index];
+          if(is_valid_task(task))
+          {
+            task();
+          }
+
+          size_t const remaining = claim_batched_task(batch);
+          if(remaining == 0)
+          {
+            break;
+          }
+          index = count - remaining;
+        }
+      }
+      catch(...)
+      {
+        size_t const remaining = batch.m_remaining.exchange(0, memory_order_relaxed);
+        m_batched_task_count.value.fetch_sub(remaining, memory_order_relaxed);
+        release_batch(batch);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        schedule_bulk(boost::make_move_iterator(batch.m_tasks.end() - remaining), boost::make_move_iterator(batch.m_tasks.end()));
+#else
+        schedule_bulk(batch.m_tasks.end() - remaining, batch.m_tasks.end());
+#endif
+        batch.m_tasks.clear();
+        throw;
+      }
+
+      release_batch(batch);
+      batch.m_tasks.clear();  // the capacity is kept for the next batch
+    }
+
+
+    // Claims the next task of the batch unless clear() discarded it. Returns the number of tasks which were not started before.
+    size_t claim_batched_task(task_batch & batch) volatile
+    {
+      size_t remaining = batch.m_remaining.load(memory_order_relaxed);
+      while(remaining > 0 && !batch.m_remaining.compare_exchange_weak(remaining, remaining - 1, memory_order_relaxed))
+      {
+      }
+      if(remaining > 0)
+      { // the previous task finished, the claimed one is active now
+        m_batched_task_count.value.fetch_sub(1, memory_order_seq_cst);
+        notify_task_waiters_if_any();
+      }
+      return remaining;
+    }
+
+
+    // Removes the batch from the list of batches in progress.
+    void release_batch(task_batch & batch) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      mutex::scoped_lock lock(self->m_task_monitor);
+      task_batch** link = &self->m_task_batches;
+      while(*link != &batch)
+      {
+        link = &(*link)->m_next;
+      }
+      *link = batch.m_next;
+    }
+
+
+    bool execute_task(idle_policy_type & idle_policy, task_batch &, mpl::true_) volatile
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      task_type task;
+
+      // fetch task without locking, sleep only if the scheduler is empty
+      for(;;)
+      {
+        // decrease number of threads if necessary
+        if(has_surplus_workers() && leave_pool())
+        {	
+          return false;	// terminate worker
+        }
+
+        if(self->m_scheduler.try_pop(task))
+        {
+          notify_task_waiters_if_any();
+          break;
+        }
+
+        // give the idle policy a chance to wait for a task without blocking
+        if(!has_surplus_workers() && await_task(idle_policy))
+        {
+          continue;
+        }
+
+        mutex::scoped_lock lock(self->m_task_monitor);
+        if(!has_surplus_workers())
+        {
+          self->m_sleeping_worker_count.value.fetch_add(1, memory_order_relaxed);
+          atomic_thread_fence(memory_order_seq_cst);
+          if(self->m_scheduler.empty())
+          {
+            m_active_worker_count.value.fetch_sub(1, memory_order_relaxed);
+            notify_task_waiters();
+            park_worker(lock);
+            m_active_worker_count.value.fetch_add(1, memory_order_relaxed);
+          }
+          self->m_sleeping_worker_count.value.fetch_sub(1, memory_order_relaxed);
+        }
+      }
+
+      // call task function
+      if(is_valid_task(task))
+      {
+        task();
+      }
+
       return true;
     }
   };
@@ -0,0 +1,64 @@
+/*! \file
+* \brief Thread affinity.
+*
+* This file contains a function which binds the calling thread 
+* to a single processor. It is implemented for Linux and Windows,
+* on other platforms the request is ignored.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_THREAD_AFFINITY_HPP_INCLUDED
+#define THREADPOOL_DETAIL_THREAD_AFFINITY_HPP_INCLUDED
+
+#include <boost/config.hpp>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(BOOST_WINDOWS)
+#include <windows.h>
+#endif
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! Binds the current thread to a processor.
+  * \param cpu The zero-based index of the processor.
+  * \return true, if the thread was bound and false if the platform does not support it or the call failed.
+  */
+  inline bool bind_current_thread_to_cpu(unsigned int const cpu)
+  {
+#if defined(__linux__) && defined(CPU_SET)
+    if(cpu >= CPU_SETSIZE)
+    {
+      return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#elif defined(BOOST_WINDOWS)
+    if(cpu >= sizeof(DWORD_PTR) * 8)
+    {
+      return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#else
+    return false;
+#endif
+  }
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_THREAD_AFFINITY_HPP_INCLUDED
@@ -0,0 +1,91 @@
+/*! \file
+* \brief Thread-local pointer.
+*
+* This file contains a static pointer slot which holds a separate value
+* for each thread. Native thread-local storage is used if the compiler
+* supports it, otherwise the slot falls back to boost::thread_specific_ptr.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_THREAD_LOCAL_PTR_HPP_INCLUDED
+#define THREADPOOL_DETAIL_THREAD_LOCAL_PTR_HPP_INCLUDED
+
+#include <boost/config.hpp>
+
+#if defined(BOOST_NO_CXX11_THREAD_LOCAL)
+#include <boost/thread/tss.hpp>
+#endif
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Static pointer with a separate value for each thread.
+  *
+  * The pointer does not own the referenced object. Each instantiation
+  * provides its own slot which is initially null in every thread.
+  *
+  * \param T The type of the referenced object.
+  * \param Tag A type which distinguishes slots of the same pointer type.
+  */
+  template <typename T, typename Tag = T>
+  class thread_local_ptr
+  {
+  public:
+    /*! Gets the pointer of the current thread.
+    * \return The pointer which was set by the current thread or null.
+    */
+    static T* get()
+    {
+#if defined(BOOST_NO_CXX11_THREAD_LOCAL)
+      return slot().get();
+#else
+      return slot();
+#endif
+    }
+
+    /*! Sets the pointer of the current thread.
+    * \param ptr The new pointer.
+    */
+    static void reset(T* const ptr)
+    {
+#if defined(BOOST_NO_CXX11_THREAD_LOCAL)
+      slot().reset(ptr);
+#else
+      slot() = ptr;
+#endif
+    }
+
+  private:
+#if defined(BOOST_NO_CXX11_THREAD_LOCAL)
+    static void release(T*)
+    {
+    }
+
+    static thread_specific_ptr<T>& slot()
+    {
+      static thread_specific_ptr<T> ptr(&release);
+      return ptr;
+    }
+#else
+    static T*& slot()
+    {
+      static thread_local T* ptr = 0;
+      return ptr;
+    }
+#endif
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_THREAD_LOCAL_PTR_HPP_INCLUDED
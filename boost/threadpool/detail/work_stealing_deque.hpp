@@ -0,0 +1,224 @@
+/*! \file
+* \brief Work-stealing deque.
+*
+* This file contains a lock-free Chase-Lev deque. The owner thread
+* pushes and pops at the bottom end, any other thread may steal from
+* the top end. The implementation follows "Correct and Efficient
+* Work-Stealing for Weak Memory Models" by N. M. Le et al.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_WORK_STEALING_DEQUE_HPP_INCLUDED
+#define THREADPOOL_DETAIL_WORK_STEALING_DEQUE_HPP_INCLUDED
+
+
+#include "cache_padded.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Lock-free single-owner deque with stealing.
+  *
+  * The deque stores pointers. push() and pop() must only be called by the
+  * owner thread, steal() may be called by any thread at any time. The
+  * circular buffer grows on demand; retired buffers are kept until the
+  * deque is destructed because a concurrent thief may still read them.
+  *
+  * \param T The type of the referenced items.
+  */
+  template <typename T>
+  class work_stealing_deque
+  : private noncopyable
+  {
+    typedef boost::intmax_t index_type;
+
+    /// Circular buffer of item pointers.
+    struct circular_array
+    : private noncopyable
+    {
+      index_type const      m_mask;
+      atomic<T*> * const    m_items;
+
+      explicit circular_array(index_type const capacity)
+        : m_mask(capacity - 1)
+        , m_items(new atomic<T*>[static_cast<std::size_t>(capacity)])
+      {
+      }
+
+      ~circular_array()
+      {
+        delete[] m_items;
+      }
+
+      index_type capacity() const
+      {
+        return m_mask + 1;
+      }
+
+      T* get(index_type const index) const
+      {
+        return m_items[index & m_mask].load(memory_order_relaxed);
+      }
+
+      void put(index_type const index, T* const item)
+      {
+        m_items[index & m_mask].store(item, memory_order_relaxed);
+      }
+
+      circular_array* grow(index_type const bottom, index_type const top) const
+      {
+        circular_array* result = new circular_array(2 * capacity());
+        for(index_type i = top; i != bottom; ++i)
+        {
+          result->put(i, get(i));
+        }
+        return result;
+      }
+    };
+
+    cache_padded<atomic<index_type> >     m_top;      // Steal end, modified by thieves and owner.
+    cache_padded<atomic<index_type> >     m_bottom;   // Owner end, modified by the owner only.
+    atomic<circular_array*>               m_array;
+    std::vector<circular_array*>          m_retired;  // Accessed by the owner only.
+
+  public:
+    /*! Constructor.
+    * \param capacity The initial capacity, must be a power of two.
+    */
+    explicit work_stealing_deque(std::size_t const capacity = 256)
+      : m_top(0)
+      , m_bottom(0)
+      , m_array(new circular_array(static_cast<index_type>(capacity)))
+    {
+    }
+
+
+    /// Destructor. Items which are still referenced are not deleted.
+    ~work_stealing_deque()
+    {
+      delete m_array.load(memory_order_relaxed);
+      for(typename std::vector<circular_array*>::iterator it = m_retired.begin();
+        it != m_retired.end();
+        ++it)
+      {
+        delete *it;
+      }
+    }
+
+
+    /*! Adds an item at the bottom end. Must be called by the owner only.
+    * \param item The item pointer which must not be null.
+    */
+    void push(T* const item)
+    {
+      index_type const bottom = m_bottom.value.load(memory_order_relaxed);
+      index_type const top = m_top.value.load(memory_order_acquire);
+      circular_array* array = m_array.load(memory_order_relaxed);
+
+      if(bottom - top > array->capacity() - 1)
+      {
+        m_retired.push_back(array);
+        array = array->grow(bottom, top);
+        m_array.store(array, memory_order_release);
+      }
+
+      array->put(bottom, item);
+      m_bottom.value.store(bottom + 1, memory_order_release);
+    }
+
+
+    /*! Removes the item at the bottom end. Must be called by the owner only.
+    * \return The most recently pushed item or null if the deque is empty.
+    */
+    T* pop()
+    {
+      index_type const bottom = m_bottom.value.load(memory_order_relaxed) - 1;
+      circular_array* const array = m_array.load(memory_order_relaxed);
+      m_bottom.value.store(bottom, memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst);
+      index_type top = m_top.value.load(memory_order_relaxed);
+
+      if(top > bottom)
+      { // deque was empty
+        m_bottom.value.store(bottom + 1, memory_order_relaxed);
+        return 0;
+      }
+
+      T* item = array->get(bottom);
+      if(top == bottom)
+      { // last item, compete with thieves
+        if(!m_top.value.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+          item = 0;
+        }
+        m_bottom.value.store(bottom + 1, memory_order_relaxed);
+      }
+      return item;
+    }
+
+
+    /*! Removes the item at the top end. May be called by any thread.
+    * \return The least recently pushed item or null if the deque is empty or the race for the item was lost.
+    */
+    T* steal()
+    {
+      index_type top = m_top.value.load(memory_order_acquire);
+      atomic_thread_fence(memory_order_seq_cst);
+      index_type const bottom = m_bottom.value.load(memory_order_acquire);
+
+      if(top >= bottom)
+      {
+        return 0;
+      }
+
+      circular_array* const array = m_array.load(memory_order_consume);
+      T* const item = array->get(top);
+      if(!m_top.value.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+      {
+        return 0;
+      }
+      return item;
+    }
+
+
+    /*! Gets the number of items. The result is only a snapshot if other threads modify the deque.
+    *  \return The number of items.
+    */
+    std::size_t size() const
+    {
+      index_type const bottom = m_bottom.value.load(memory_order_relaxed);
+      index_type const top = m_top.value.load(memory_order_relaxed);
+      return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+
+    /*! Checks if the deque is empty. The result is only a snapshot if other threads modify the deque.
+    *  \return true if the deque contains no items, false otherwise.
+    */
+    bool empty() const
+    {
+      return m_bottom.value.load(memory_order_relaxed) <= m_top.value.load(memory_order_relaxed);
+    }
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_WORK_STEALING_DEQUE_HPP_INCLUDED
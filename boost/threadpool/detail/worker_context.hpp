@@ -0,0 +1,119 @@
+/*! \file
+* \brief Worker context.
+*
+* This file contains the interface through which a thread finds out
+* whether it is a pool worker. Workers which have to wait for other
+* tasks use it to execute pending tasks of their pool in the meantime.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_WORKER_CONTEXT_HPP_INCLUDED
+#define THREADPOOL_DETAIL_WORKER_CONTEXT_HPP_INCLUDED
+
+
+#include "thread_local_ptr.hpp"
+
+#include <boost/thread/xtime.hpp>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Worker which runs the current thread.
+  *
+  * Each worker registers itself for the lifetime of its thread.
+  */
+  class worker_context
+  {
+    unsigned int m_help_depth;  // Number of nested waits in which the worker executes pending tasks.
+
+  public:
+    /// The interval in which a helping thread which found no task looks for new tasks again.
+    static long const help_interval_milliseconds = 1;
+
+    /*! Gets the worker of the current thread.
+    * \return The worker or null if the current thread is not a pool worker.
+    */
+    static worker_context* current()
+    {
+      return thread_local_ptr<worker_context>::get();
+    }
+
+    /*! Executes one pending task of the worker's pool.
+    * \return true, if a task was executed and false if no task was pending.
+    */
+    virtual bool execute_pending_task() = 0;
+
+    /*! Gets the pool which owns the worker.
+    * \return The pool's core.
+    */
+    virtual void const volatile * pool() const = 0;
+
+    /*! Registers that the worker starts to execute pending tasks while it waits.
+    * \return true, if the wait is the worker's outermost helping wait.
+    */
+    bool enter_help()
+    {
+      return m_help_depth++ == 0;
+    }
+
+    /*! Registers that the worker stops to execute pending tasks while it waits.
+    * \return true, if the wait was the worker's outermost helping wait.
+    */
+    bool leave_help()
+    {
+      return --m_help_depth == 0;
+    }
+
+  protected:
+    worker_context()
+      : m_help_depth(0)
+    {
+    }
+
+    ~worker_context()
+    {
+    }
+
+    static void set_current(worker_context* const worker)
+    {
+      thread_local_ptr<worker_context>::reset(worker);
+    }
+  };
+
+
+  /*! Gets the time when a helping thread looks for new tasks again.
+  * \param deadline Optional deadline which is not exceeded.
+  * \return The time one help interval from now or the deadline, whichever comes first.
+  */
+  inline xtime next_help_time(xtime const * const deadline)
+  {
+    xtime result;
+    xtime_get(&result, TIME_UTC_);
+    result.nsec += worker_context::help_interval_milliseconds * 1000000;
+    if(result.nsec >= 1000000000)
+    {
+      result.nsec -= 1000000000;
+      ++result.sec;
+    }
+
+    if(deadline && xtime_cmp(*deadline, result) < 0)
+    {
+      return *deadline;
+    }
+    return result;
+  }
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_WORKER_CONTEXT_HPP_INCLUDED
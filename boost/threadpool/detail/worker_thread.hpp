@@ -19,6 +19,7 @@
 
 
 #include "scope_guard.hpp"
+#include "worker_context.hpp"
 
 #include <boost/smart_ptr.hpp>
 #include <boost/thread.hpp>
@@ -43,6 +44,7 @@ namespace boost { namespace threadpool { namespace detail
   template <typename Pool>
   class worker_thread
   : public enable_shared_from_this< worker_thread<Pool> > 
+  , public worker_context
   , private noncopyable
   {
   public:
@@ -79,13 +81,37 @@ namespace boost { namespace threadpool { namespace detail
 	  { 
 		  scope_guard notify_exception(bind(&worker_thread::died_unexpectedly, this));
 
-		  while(m_pool->execute_task()) {}
+		  typename pool_type::idle_policy_type idle_policy;
+		  typename pool_type::task_batch batch;
+
+		  set_current(this);
+		  m_pool->worker_started();
+		  while(m_pool->execute_task(idle_policy, batch)) {}
+		  set_current(0);
 
 		  notify_exception.disable();
 		  m_pool->worker_destructed(this->shared_from_this());
 	  }
 
 
+	  /*! Executes one pending task of the pool. Called by the worker's own thread while it waits.
+	  * \return true, if a task was executed and false if no task was pending.
+	  */
+	  bool execute_pending_task()
+	  {
+		  return m_pool->execute_pending_task();
+	  }
+
+
+	  /*! Gets the pool which owns the worker.
+	  * \return The pool's core.
+	  */
+	  void const volatile * pool() const
+	  {
+		  return m_pool.get();
+	  }
+
+
 	  /*! Joins the worker's thread.
 	  */
 	  void join()
@@ -0,0 +1,254 @@
+/*! \file
+* \brief Fork-join primitives.
+*
+* This file contains the fork_join class, which spawns tasks and syncs with
+* them, and parallel_invoke, which executes a few function objects in parallel.
+* Recursive divide-and-conquer algorithms can be built on them without a
+* barrier per recursion level.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_FORK_JOIN_HPP_INCLUDED
+#define THREADPOOL_FORK_JOIN_HPP_INCLUDED
+
+
+#include "task_group.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /*! \brief Spawned function which is executed either by the pool or inline by sync(), whoever claims it first.
+    *
+    * The scope is notified when the function was executed or discarded.
+    */
+    class spawned_task
+    : private noncopyable
+    {
+      function0<void>               m_function;
+      shared_ptr<task_group_state>  m_scope;
+      atomic<bool>                  m_claimed;
+
+    public:
+      spawned_task(function0<void> const & function, shared_ptr<task_group_state> const & scope)
+        : m_function(function)
+        , m_scope(scope)
+        , m_claimed(false)
+      {
+        m_scope->task_added();
+      }
+
+      bool claim()
+      {
+        return !m_claimed.load(memory_order_relaxed) && !m_claimed.exchange(true, memory_order_acquire);
+      }
+
+      void run()
+      {
+        if(claim())
+        {
+          try
+          {
+            m_function();
+          }
+          catch(...)
+          {
+            m_scope->task_finished();
+            throw;
+          }
+          m_scope->task_finished();
+        }
+      }
+
+      void discard()
+      {
+        if(claim())
+        {
+          m_scope->task_finished();
+        }
+      }
+    };
+
+
+    /// Task which lets a worker of the pool run a spawned function.
+    class spawned_task_func
+    {
+      shared_ptr<spawned_task> m_task;
+
+    public:
+      typedef void result_type;
+
+      explicit spawned_task_func(shared_ptr<spawned_task> const & task)
+        : m_task(task)
+      {
+      }
+
+      void operator()() const
+      {
+        m_task->run();
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! \brief Scope for spawning tasks and syncing with them.
+  *
+  * spawn() schedules a function on the pool where idle workers can take it.
+  * sync() executes the spawned functions which no worker has started yet
+  * inline in reverse order, which keeps the most recently spawned (cache warm)
+  * work on the calling thread, and then waits only for the functions which
+  * other workers are running. A worker which waits executes pending tasks of
+  * its pool in the meantime.
+  *
+  * A fork_join object must only be used by the thread which created it.
+  * Its destructor discards functions which were not started and waits for the others.
+  *
+  * \param Pool The pool type. Its task type must be constructible from a nullary function object.
+  *
+  * \see parallel_invoke
+  */
+  template <typename Pool = pool>
+  class fork_join
+  : private noncopyable
+  {
+    Pool                                              m_pool;
+    shared_ptr<detail::task_group_state>              m_state;     // Counts the functions which are neither executed nor discarded.
+    std::vector<shared_ptr<detail::spawned_task> >    m_spawned;   // Spawned since the last sync().
+
+  public:
+    typedef Pool pool_type;   //!< Indicates the pool's type.
+
+    /*! Constructor.
+    * \param pool The pool which executes the spawned functions.
+    */
+    explicit fork_join(pool_type const & pool)
+      : m_pool(pool)
+      , m_state(new detail::task_group_state)
+    {
+    }
+
+
+    /// Destructor. Discards the functions which were not started and waits for the others.
+    ~fork_join()
+    {
+      for(std::vector<shared_ptr<detail::spawned_task> >::iterator it = m_spawned.begin();
+        it != m_spawned.end();
+        ++it)
+      {
+        (*it)->discard();
+      }
+      m_state->wait(0);
+    }
+
+
+    /*! Spawns a function which is executed in parallel to the caller.
+    * \param function The function object. It should not throw exceptions.
+    */
+    template <typename Function>
+    void spawn(Function const & function)
+    {
+      shared_ptr<detail::spawned_task> task(new detail::spawned_task(function, m_state));
+      m_spawned.push_back(task);
+      m_pool.schedule(detail::spawned_task_func(task)); // if the pool rejects the task sync() executes it
+    }
+
+
+    /*! Executes the spawned functions which have not been started, then waits until all are finished.
+    */
+    void sync()
+    {
+      while(!m_spawned.empty())
+      {
+        shared_ptr<detail::spawned_task> const task = m_spawned.back();
+        m_spawned.pop_back();
+        task->run();
+      }
+      m_state->wait(0);
+    }
+  };
+
+
+  /*! Executes two function objects in parallel. The first one is executed by the calling thread.
+  * \param pool The pool which executes the other function objects.
+  * \param f1 The first function object.
+  * \param f2 The second function object.
+  * \remarks The function returns when all function objects are finished.
+  *  They should not throw exceptions.
+  */
+  template <typename Pool, typename F1, typename F2>
+  void parallel_invoke(Pool const & pool, F1 const & f1, F2 const & f2)
+  {
+    fork_join<Pool> scope(pool);
+    scope.spawn(f2);
+    f1();
+    scope.sync();
+  }
+
+
+  /*! Executes three function objects in parallel. The first one is executed by the calling thread.
+  * \see parallel_invoke(Pool const &, F1 const &, F2 const &)
+  */
+  template <typename Pool, typename F1, typename F2, typename F3>
+  void parallel_invoke(Pool const & pool, F1 const & f1, F2 const & f2, F3 const & f3)
+  {
+    fork_join<Pool> scope(pool);
+    scope.spawn(f3);
+    scope.spawn(f2);
+    f1();
+    scope.sync();
+  }
+
+
+  /*! Executes four function objects in parallel. The first one is executed by the calling thread.
+  * \see parallel_invoke(Pool const &, F1 const &, F2 const &)
+  */
+  template <typename Pool, typename F1, typename F2, typename F3, typename F4>
+  void parallel_invoke(Pool const & pool, F1 const & f1, F2 const & f2, F3 const & f3, F4 const & f4)
+  {
+    fork_join<Pool> scope(pool);
+    scope.spawn(f4);
+    scope.spawn(f3);
+    scope.spawn(f2);
+    f1();
+    scope.sync();
+  }
+
+
+  /*! Executes five function objects in parallel. The first one is executed by the calling thread.
+  * \see parallel_invoke(Pool const &, F1 const &, F2 const &)
+  */
+  template <typename Pool, typename F1, typename F2, typename F3, typename F4, typename F5>
+  void parallel_invoke(Pool const & pool, F1 const & f1, F2 const & f2, F3 const & f3, F4 const & f4, F5 const & f5)
+  {
+    fork_join<Pool> scope(pool);
+    scope.spawn(f5);
+    scope.spawn(f4);
+    scope.spawn(f3);
+    scope.spawn(f2);
+    f1();
+    scope.sync();
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_FORK_JOIN_HPP_INCLUDED
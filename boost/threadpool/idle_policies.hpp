@@ -0,0 +1,187 @@
+/*! \file
+* \brief Idle policies.
+*
+* This file contains idle policies for thread_pool. 
+* An idle policy controls what a worker does when it finds no task
+* before it blocks. Each worker owns a separate policy object.
+* A worker which waits in the idle policy is not counted as active.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_IDLE_POLICIES_HPP_INCLUDED
+#define THREADPOOL_IDLE_POLICIES_HPP_INCLUDED
+
+
+#include "./detail/cpu_relax.hpp"
+
+#include <boost/thread/thread.hpp>
+
+
+
+/// The namespace threadpool contains a thread pool and related utility classes.
+namespace boost { namespace threadpool
+{
+
+
+  /*! \brief IdlePolicy which blocks the worker as soon as no task is available.
+  *
+  * Idle workers consume no processor time, but it takes a thread wakeup
+  * until a new task is executed.
+  *
+  * \param Pool The pool's core type.
+  */ 
+  template<typename Pool>
+  class block_when_idle
+  {
+  public:
+    /*! Called by a worker which found no task before it blocks.
+    * \param pool The pool.
+    * \return true, if the worker should look for a task again instead of blocking.
+    */
+    bool await_task(Pool const volatile &)
+    {
+      return false;
+    }
+  };
+
+
+
+  /*! \brief IdlePolicy which spins and yields for a while before the worker blocks.
+  *
+  * The worker polls the scheduler with pause instructions, then yields its 
+  * time slice a few times and blocks if no task arrived in the meantime.
+  * The spin window adapts to the worker's hit rate: it grows while spinning
+  * finds tasks and shrinks to a minimum when the worker blocks anyway.
+  * Bursty task streams are picked up without a thread wakeup.
+  * Spinning workers occupy processors which might be used by other threads.
+  *
+  * \param Pool The pool's core type.
+  */ 
+  template<typename Pool>
+  class spin_then_park
+  {
+  public:
+    static unsigned int const min_spins   = 16;     //!< The smallest spin window.
+    static unsigned int const max_spins   = 2048;   //!< The largest spin window.
+    static unsigned int const yields      = 4;      //!< The number of yields after spinning.
+
+  private:
+    static unsigned int const rate_scale  = 256;    // Hit rate which corresponds to 100%.
+
+    unsigned int m_hit_rate;    // Exponentially weighted share of waits which found a task, scaled by rate_scale.
+    unsigned int m_spin_limit;  // The current spin window.
+
+  public:
+    /// Constructor.
+    spin_then_park()
+      : m_hit_rate(rate_scale / 2)
+      , m_spin_limit(spin_limit_for(rate_scale / 2))
+    {
+    }
+
+
+    /*! Called by a worker which found no task before it blocks.
+    * \param pool The pool.
+    * \return true, if a task became available and the worker should not block.
+    */
+    bool await_task(Pool const volatile & pool)
+    {
+      for(unsigned int i = 0; i < m_spin_limit; ++i)
+      {
+        if(!pool.empty()) return record(true);
+        detail::cpu_relax();
+      }
+
+      for(unsigned int i = 0; i < yields; ++i)
+      {
+        if(!pool.empty()) return record(true);
+        this_thread::yield();
+      }
+
+      return record(false);
+    }
+
+
+    /*! Gets the share of waits which were ended by a task.
+    * \return The hit rate between 0 and 1.
+    */
+    double hit_rate() const
+    {
+      return static_cast<double>(m_hit_rate) / rate_scale;
+    }
+
+
+    /*! Gets the current number of spins before the worker yields.
+    * \return The spin window.
+    */
+    unsigned int spin_limit() const
+    {
+      return m_spin_limit;
+    }
+
+  private:
+    bool record(bool const hit)
+    {
+      if(hit)
+      {
+        m_hit_rate += (rate_scale - m_hit_rate) / 8;
+      }
+      else
+      {
+        m_hit_rate -= (m_hit_rate + 7) / 8;
+      }
+      m_spin_limit = spin_limit_for(m_hit_rate);
+      return hit;
+    }
+
+    static unsigned int spin_limit_for(unsigned int const hit_rate)
+    {
+      return min_spins + (max_spins - min_spins) * hit_rate / rate_scale;
+    }
+  };
+
+
+  /*! \brief IdlePolicy which never blocks the worker.
+  *
+  * The worker polls the scheduler continuously and never waits for a 
+  * notification, so a new task is picked up without any wakeup latency.
+  * Each worker occupies a processor completely, even if the pool is idle.
+  * Intended for pools whose workers run on dedicated processors, see
+  * thread_pool::set_worker_cpus(). The processors are released when the 
+  * pool is resized or stopped.
+  *
+  * \param Pool The pool's core type.
+  */ 
+  template<typename Pool>
+  class busy_poll
+  {
+  public:
+    static unsigned int const polls = 1024;   //!< The number of polls before the worker checks whether it has to terminate.
+
+    /*! Called by a worker which found no task instead of blocking.
+    * \param pool The pool.
+    * \return Always true, the worker does not block.
+    */
+    bool await_task(Pool const volatile & pool)
+    {
+      for(unsigned int i = 0; i < polls && pool.empty(); ++i)
+      {
+        detail::cpu_relax();
+      }
+      return true;
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_IDLE_POLICIES_HPP_INCLUDED
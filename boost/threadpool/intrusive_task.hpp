@@ -0,0 +1,112 @@
+/*! \file
+* \brief Intrusive tasks.
+*
+* This file contains intrusive_task_hook, a base class which makes an object
+* schedulable without copying it, and intrusive_task, the task function object
+* which refers to such an object.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_INTRUSIVE_TASK_HPP_INCLUDED
+#define THREADPOOL_INTRUSIVE_TASK_HPP_INCLUDED
+
+
+#include "./detail/intrusive_mpsc_queue.hpp"
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Base class of objects which are scheduled intrusively.
+  *
+  * The hook contains the link which the intrusive_fifo_scheduler uses to queue
+  * the object, so scheduling neither copies the object nor allocates memory.
+  * The caller keeps the ownership: the object must stay valid until its run()
+  * function has been called and must not be scheduled again before. It may
+  * schedule itself again from run(). A copy of a hook is not scheduled.
+  *
+  * \see intrusive_task, intrusive_fifo_scheduler
+  */
+  class intrusive_task_hook
+  : public detail::intrusive_queue_node
+  {
+  public:
+    /// Destructor.
+    virtual ~intrusive_task_hook()
+    {
+    }
+
+    /*! Executes the task. Should not throw exceptions.
+    */
+    virtual void run() = 0;
+  };
+
+
+  /*! \brief Task function object which refers to an intrusive_task_hook.
+  *
+  * The task is a pointer to the hooked object and calls its run() function.
+  * It is implicitly constructible from the object, so pool.schedule(object)
+  * schedules the object itself.
+  *
+  * \see intrusive_task_hook
+  */
+  class intrusive_task
+  {
+    intrusive_task_hook* m_hook;    //!< Null if the task is empty.
+
+  public:
+    typedef void result_type; //!< Indicates the functor's result type.
+
+  public:
+    /*! Constructs an empty task.
+    */
+    intrusive_task()
+      : m_hook(0)
+    {
+    }
+
+    /*! Constructor.
+    * \param hook The object which is executed by the task.
+    */
+    intrusive_task(intrusive_task_hook & hook)
+      : m_hook(&hook)
+    {
+    }
+
+    /*! Executes the object's run() function.
+    */
+    void operator() (void) const
+    {
+      m_hook->run();
+    }
+
+    /*! Checks if the task refers to no object.
+    * \return true if the task is empty, false otherwise.
+    */
+    bool empty() const
+    {
+      return m_hook == 0;
+    }
+
+    /*! Gets the object which is executed by the task.
+    * \return The hook of the object or null if the task is empty.
+    */
+    intrusive_task_hook* hook() const
+    {
+      return m_hook;
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_INTRUSIVE_TASK_HPP_INCLUDED
@@ -0,0 +1,105 @@
+/*! \file
+* \brief Parallel loop.
+*
+* This file contains parallel_for, which applies a function object to
+* the chunks of an index range in parallel.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARALLEL_FOR_HPP_INCLUDED
+#define THREADPOOL_PARALLEL_FOR_HPP_INCLUDED
+
+
+#include "fork_join.hpp"
+#include "partitioners.hpp"
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /*! \brief Processes a range, spawning the parts which the partitioner splits off.
+    */
+    template <typename Pool, typename Range, typename Body, typename Partitioner>
+    class parallel_for_task
+    {
+      Pool const *  m_pool;   // The caller of parallel_for blocks until all tasks are finished.
+      Range         m_range;
+      Body const *  m_body;
+      Partitioner   m_partitioner;
+
+    public:
+      typedef void result_type;
+
+      parallel_for_task(Pool const & pool, Range const & range, Body const & body, Partitioner const & partitioner)
+        : m_pool(&pool)
+        , m_range(range)
+        , m_body(&body)
+        , m_partitioner(partitioner)
+      {
+      }
+
+      void operator()() const
+      {
+        Range range(m_range);
+        Partitioner partitioner(m_partitioner);
+        fork_join<Pool> scope(*m_pool);
+
+        while(!range.empty())
+        {
+          Range upper;
+          Partitioner upper_partitioner(partitioner);
+          while(partitioner.divide(*m_pool, range, upper, upper_partitioner))
+          {
+            scope.spawn(parallel_for_task(*m_pool, upper, *m_body, upper_partitioner));
+          }
+
+          (*m_body)(partitioner.next_chunk(range));
+        }
+
+        scope.sync();
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! Applies a function object to the chunks of a range in parallel.
+  *  The calling thread participates and the function returns when all chunks are processed.
+  * \param pool The pool whose workers process the chunks.
+  * \param range The index range.
+  * \param body A function object which implements 'void operator()(Range const &) const'.
+  *  It is called concurrently for disjoint chunks and should not throw exceptions.
+  * \param partitioner Determines how the range is divided into chunks.
+  * \see static_partitioner, simple_partitioner, adaptive_partitioner
+  */
+  template <typename Pool, typename Range, typename Body, typename Partitioner>
+  void parallel_for(Pool const & pool, Range const & range, Body const & body, Partitioner const & partitioner)
+  {
+    detail::parallel_for_task<Pool, Range, Body, Partitioner>(pool, range, body, partitioner)();
+  }
+
+
+  /*! Applies a function object to the chunks of a range in parallel. The range is divided by an adaptive_partitioner.
+  * \see parallel_for(Pool const &, Range const &, Body const &, Partitioner const &)
+  */
+  template <typename Pool, typename Range, typename Body>
+  void parallel_for(Pool const & pool, Range const & range, Body const & body)
+  {
+    parallel_for(pool, range, body, adaptive_partitioner());
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARALLEL_FOR_HPP_INCLUDED
@@ -0,0 +1,218 @@
+/*! \file
+* \brief Parallel reduction.
+*
+* This file contains parallel_reduce and parallel_transform_reduce, which
+* aggregate a range in parallel. Each chunk is reduced into a partial
+* result of its own and the partial results are combined along the tree
+* of splits, so no accumulator is shared between threads.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARALLEL_REDUCE_HPP_INCLUDED
+#define THREADPOOL_PARALLEL_REDUCE_HPP_INCLUDED
+
+
+#include "fork_join.hpp"
+#include "partitioners.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /*! \brief Reduces a range into a result, spawning the parts which the partitioner splits off.
+    */
+    template <typename Pool, typename Range, typename Value, typename Body, typename Reduction, typename Partitioner>
+    class parallel_reduce_task
+    {
+      Pool const *        m_pool;       // The caller of parallel_reduce blocks until all tasks are finished.
+      Range               m_range;
+      Value const *       m_identity;
+      Body const *        m_body;
+      Reduction const *   m_reduction;
+      Partitioner         m_partitioner;
+      Value *             m_result;
+
+    public:
+      typedef void result_type;
+
+      parallel_reduce_task(Pool const & pool, Range const & range, Value const & identity, Body const & body,
+                           Reduction const & reduction, Partitioner const & partitioner, Value & result)
+        : m_pool(&pool)
+        , m_range(range)
+        , m_identity(&identity)
+        , m_body(&body)
+        , m_reduction(&reduction)
+        , m_partitioner(partitioner)
+        , m_result(&result)
+      {
+      }
+
+      void operator()() const
+      {
+        Range range(m_range);
+        Partitioner partitioner(m_partitioner);
+        Value result(*m_identity);
+        std::deque<Value> partial_results;  // Of the spawned parts, the upper ones first. Elements keep their address.
+
+        {
+          fork_join<Pool> scope(*m_pool);
+          while(!range.empty())
+          {
+            Range upper;
+            Partitioner upper_partitioner(partitioner);
+            while(partitioner.divide(*m_pool, range, upper, upper_partitioner))
+            {
+              partial_results.push_back(*m_identity);
+              scope.spawn(parallel_reduce_task(*m_pool, upper, *m_identity, *m_body, *m_reduction, upper_partitioner, partial_results.back()));
+            }
+
+            result = (*m_body)(partitioner.next_chunk(range), result);
+          }
+          scope.sync();
+        }
+
+        // combine in index order
+        for(typename std::deque<Value>::reverse_iterator it = partial_results.rbegin();
+          it != partial_results.rend();
+          ++it)
+        {
+          result = (*m_reduction)(result, *it);
+        }
+        *m_result = result;
+      }
+    };
+
+
+    /*! \brief Chunk body of parallel_transform_reduce.
+    *
+    * The loop keeps four independent accumulators so that consecutive iterations do not
+    * depend on each other, which lets the compiler vectorize and pipeline contiguous chunks.
+    */
+    template <typename RandomAccessIterator, typename Value, typename Reduction, typename Transform>
+    class transform_reduce_body
+    {
+      RandomAccessIterator  m_first;
+      Value                 m_identity;
+      Reduction             m_reduction;
+      Transform             m_transform;
+
+    public:
+      transform_reduce_body(RandomAccessIterator const & first, Value const & identity, Reduction const & reduction, Transform const & transform)
+        : m_first(first)
+        , m_identity(identity)
+        , m_reduction(reduction)
+        , m_transform(transform)
+      {
+      }
+
+      Value operator()(index_range<std::size_t> const & range, Value const & init) const
+      {
+        RandomAccessIterator const first = m_first + static_cast<typename std::iterator_traits<RandomAccessIterator>::difference_type>(range.begin());
+        std::size_t const size = range.size();
+
+        Value sum0(init);
+        Value sum1(m_identity);
+        Value sum2(m_identity);
+        Value sum3(m_identity);
+
+        std::size_t i = 0;
+        for(; i + 4 <= size; i += 4)
+        {
+          sum0 = m_reduction(sum0, m_transform(first[i]));
+          sum1 = m_reduction(sum1, m_transform(first[i + 1]));
+          sum2 = m_reduction(sum2, m_transform(first[i + 2]));
+          sum3 = m_reduction(sum3, m_transform(first[i + 3]));
+        }
+        for(; i < size; ++i)
+        {
+          sum0 = m_reduction(sum0, m_transform(first[i]));
+        }
+
+        return m_reduction(m_reduction(sum0, sum1), m_reduction(sum2, sum3));
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! Reduces a range in parallel. The calling thread participates.
+  * \param pool The pool whose workers reduce the chunks.
+  * \param range The index range.
+  * \param identity The identity element of the reduction, e.g. 0 for addition.
+  * \param body A function object which implements 'Value operator()(Range const & chunk, Value const & init) const'.
+  *  It returns init combined with the chunk's elements and is called concurrently for disjoint chunks.
+  * \param reduction A function object which implements 'Value operator()(Value const &, Value const &) const'.
+  *  It must be associative, but need not be commutative: partial results are combined in index order.
+  * \param partitioner Determines how the range is divided into chunks.
+  * \return The reduction of all elements.
+  * \remarks The function objects should not throw exceptions.
+  */
+  template <typename Pool, typename Range, typename Value, typename Body, typename Reduction, typename Partitioner>
+  Value parallel_reduce(Pool const & pool, Range const & range, Value const & identity, Body const & body, Reduction const & reduction, Partitioner const & partitioner)
+  {
+    Value result(identity);
+    detail::parallel_reduce_task<Pool, Range, Value, Body, Reduction, Partitioner>(pool, range, identity, body, reduction, partitioner, result)();
+    return result;
+  }
+
+
+  /*! Reduces a range in parallel. The range is divided by an adaptive_partitioner.
+  * \see parallel_reduce(Pool const &, Range const &, Value const &, Body const &, Reduction const &, Partitioner const &)
+  */
+  template <typename Pool, typename Range, typename Value, typename Body, typename Reduction>
+  Value parallel_reduce(Pool const & pool, Range const & range, Value const & identity, Body const & body, Reduction const & reduction)
+  {
+    return parallel_reduce(pool, range, identity, body, reduction, adaptive_partitioner());
+  }
+
+
+  /*! Transforms the elements of a sequence and reduces the results in parallel. The calling thread participates.
+  * \param pool The pool whose workers reduce the chunks.
+  * \param first The first element of the sequence.
+  * \param last The end of the sequence.
+  * \param identity The identity element of the reduction, e.g. 0 for addition.
+  * \param reduction A function object which implements 'Value operator()(Value const &, Value const &) const'.
+  *  It must be associative and commutative because each chunk is reduced in an interleaved order.
+  * \param transform A function object which is applied to each element and returns a Value.
+  * \param partitioner Determines how the sequence is divided into chunks.
+  * \return The reduction of all transformed elements.
+  * \remarks The function objects should not throw exceptions.
+  */
+  template <typename Pool, typename RandomAccessIterator, typename Value, typename Reduction, typename Transform, typename Partitioner>
+  Value parallel_transform_reduce(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, Value const & identity,
+                                  Reduction const & reduction, Transform const & transform, Partitioner const & partitioner)
+  {
+    detail::transform_reduce_body<RandomAccessIterator, Value, Reduction, Transform> const body(first, identity, reduction, transform);
+    return parallel_reduce(pool, index_range<std::size_t>(0, static_cast<std::size_t>(last - first)), identity, body, reduction, partitioner);
+  }
+
+
+  /*! Transforms the elements of a sequence and reduces the results in parallel. The sequence is divided by an adaptive_partitioner.
+  * \see parallel_transform_reduce(Pool const &, RandomAccessIterator, RandomAccessIterator, Value const &, Reduction const &, Transform const &, Partitioner const &)
+  */
+  template <typename Pool, typename RandomAccessIterator, typename Value, typename Reduction, typename Transform>
+  Value parallel_transform_reduce(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, Value const & identity,
+                                  Reduction const & reduction, Transform const & transform)
+  {
+    return parallel_transform_reduce(pool, first, last, identity, reduction, transform, adaptive_partitioner());
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARALLEL_REDUCE_HPP_INCLUDED
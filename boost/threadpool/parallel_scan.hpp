@@ -0,0 +1,271 @@
+/*! \file
+* \brief Parallel prefix scan.
+*
+* This file contains parallel_inclusive_scan and parallel_exclusive_scan.
+* The sequence is divided into blocks which fit into the L2 cache. The
+* first pass sums up the blocks in parallel, a short serial step turns the
+* block sums into block offsets and the second pass scans the blocks in
+* parallel, starting each block with its offset.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARALLEL_SCAN_HPP_INCLUDED
+#define THREADPOOL_PARALLEL_SCAN_HPP_INCLUDED
+
+
+#include "parallel_for.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /// Number of bytes of input and output per block. Half of a typical L2 cache, so a block is still cached in the second pass.
+    static std::size_t const scan_block_bytes = 128 * 1024;
+
+
+    /*! \brief Blocks of a scanned sequence.
+    */
+    template <typename InputIterator, typename OutputIterator, typename Value, typename BinaryOperation>
+    class scan_blocks
+    {
+      InputIterator const       m_first;
+      OutputIterator const      m_result;
+      std::size_t const         m_size;
+      std::size_t const         m_block_size;
+      BinaryOperation const     m_op;
+      bool const                m_has_init;     // If false the first block starts without an offset.
+      std::vector<Value>        m_offsets;      // The value each block starts with. After the first pass the sum of the preceding block.
+
+    public:
+      scan_blocks(InputIterator first, OutputIterator result, std::size_t size, BinaryOperation const & op, Value const * init)
+        : m_first(first)
+        , m_result(result)
+        , m_size(size)
+        , m_block_size(block_size())
+        , m_op(op)
+        , m_has_init(init != 0)
+        , m_offsets(count(), init ? *init : Value(*first))
+      {
+      }
+
+      static std::size_t block_size()
+      {
+        typedef typename std::iterator_traits<InputIterator>::value_type input_type;
+        std::size_t const element_bytes = sizeof(input_type) + sizeof(Value);
+        return element_bytes < scan_block_bytes ? scan_block_bytes / element_bytes : 1;
+      }
+
+      std::size_t count() const
+      {
+        return (m_size + m_block_size - 1) / m_block_size;
+      }
+
+      // Computes the sums of the blocks which precede the last one.
+      void sum_up(index_range<std::size_t> const & blocks)
+      {
+        for(std::size_t block = blocks.begin(); block != blocks.end(); ++block)
+        {
+          InputIterator it = m_first + static_cast<std::ptrdiff_t>(block * m_block_size);
+          InputIterator const end = it + static_cast<std::ptrdiff_t>(m_block_size);
+          Value sum(*it);
+          for(++it; it != end; ++it)
+          {
+            sum = m_op(sum, *it);
+          }
+          m_offsets[block + 1] = sum;
+        }
+      }
+
+      // Turns the block sums into the offsets of the blocks.
+      void accumulate_offsets()
+      {
+        for(std::size_t block = m_has_init ? 1 : 2; block < m_offsets.size(); ++block)
+        {
+          m_offsets[block] = m_op(m_offsets[block - 1], m_offsets[block]);
+        }
+      }
+
+      // Writes the inclusive scan of the blocks.
+      void scan_inclusive(index_range<std::size_t> const & blocks) const
+      {
+        for(std::size_t block = blocks.begin(); block != blocks.end(); ++block)
+        {
+          std::size_t const begin = block * m_block_size;
+          std::size_t const end = begin + m_block_size < m_size ? begin + m_block_size : m_size;
+          InputIterator it = m_first + static_cast<std::ptrdiff_t>(begin);
+          InputIterator const last = m_first + static_cast<std::ptrdiff_t>(end);
+          OutputIterator out = m_result + static_cast<std::ptrdiff_t>(begin);
+
+          Value sum(block > 0 ? m_op(m_offsets[block], *it) : Value(*it));
+          *out = sum;
+          for(++it, ++out; it != last; ++it, ++out)
+          {
+            sum = m_op(sum, *it);
+            *out = sum;
+          }
+        }
+      }
+
+      // Writes the exclusive scan of the blocks.
+      void scan_exclusive(index_range<std::size_t> const & blocks) const
+      {
+        for(std::size_t block = blocks.begin(); block != blocks.end(); ++block)
+        {
+          std::size_t const begin = block * m_block_size;
+          std::size_t const end = begin + m_block_size < m_size ? begin + m_block_size : m_size;
+          InputIterator it = m_first + static_cast<std::ptrdiff_t>(begin);
+          InputIterator const last = m_first + static_cast<std::ptrdiff_t>(end);
+          OutputIterator out = m_result + static_cast<std::ptrdiff_t>(begin);
+
+          Value sum(m_offsets[block]);
+          for(; it != last; ++it, ++out)
+          {
+            Value const next(m_op(sum, *it)); // read before writing, the output may alias the input
+            *out = sum;
+            sum = next;
+          }
+        }
+      }
+    };
+
+
+    /// Calls a member function of the scan blocks for a range of blocks.
+    template <typename Blocks, void (Blocks::*Pass)(index_range<std::size_t> const &)>
+    struct scan_pass
+    {
+      Blocks* blocks;
+
+      void operator()(index_range<std::size_t> const & range) const
+      {
+        (blocks->*Pass)(range);
+      }
+    };
+
+
+    template <typename Blocks, void (Blocks::*Pass)(index_range<std::size_t> const &) const>
+    struct const_scan_pass
+    {
+      Blocks const * blocks;
+
+      void operator()(index_range<std::size_t> const & range) const
+      {
+        (blocks->*Pass)(range);
+      }
+    };
+
+
+    template <typename Pool, typename InputIterator, typename OutputIterator, typename Value, typename BinaryOperation>
+    OutputIterator parallel_scan(Pool const & pool, InputIterator first, InputIterator last, OutputIterator result,
+                                 BinaryOperation const & op, Value const * init)
+    {
+      typedef scan_blocks<InputIterator, OutputIterator, Value, BinaryOperation> blocks_type;
+
+      std::size_t const size = static_cast<std::size_t>(last - first);
+      if(size == 0)
+      {
+        return result;
+      }
+
+      blocks_type blocks(first, result, size, op, init);
+
+      // pass one: sum up all blocks except the last one
+      std::size_t const count = blocks.count();
+      scan_pass<blocks_type, &blocks_type::sum_up> const sum_up = { &blocks };
+      parallel_for(pool, index_range<std::size_t>(0, count - 1), sum_up, simple_partitioner(1));
+
+      // serial step: block offsets
+      blocks.accumulate_offsets();
+
+      // pass two: scan all blocks
+      if(init)
+      {
+        const_scan_pass<blocks_type, &blocks_type::scan_exclusive> const scan = { &blocks };
+        parallel_for(pool, index_range<std::size_t>(0, count), scan, simple_partitioner(1));
+      }
+      else
+      {
+        const_scan_pass<blocks_type, &blocks_type::scan_inclusive> const scan = { &blocks };
+        parallel_for(pool, index_range<std::size_t>(0, count), scan, simple_partitioner(1));
+      }
+
+      return result + static_cast<std::ptrdiff_t>(size);
+    }
+
+  } // namespace detail
+
+
+  /*! Computes the inclusive prefix scan of a sequence in parallel: the i-th output is the combination of the first i + 1 inputs.
+  *  The calling thread participates.
+  * \param pool The pool whose workers scan the blocks.
+  * \param first The first element of the sequence.
+  * \param last The end of the sequence.
+  * \param result The first element of the output sequence. It may be equal to first.
+  * \param op An associative function object which implements 'Value operator()(Value const &, Value const &) const'.
+  * \return The end of the output sequence.
+  * \remarks The function object should not throw exceptions.
+  */
+  template <typename Pool, typename RandomAccessIterator, typename OutputIterator, typename BinaryOperation>
+  OutputIterator parallel_inclusive_scan(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, OutputIterator result, BinaryOperation const & op)
+  {
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    return detail::parallel_scan<Pool, RandomAccessIterator, OutputIterator, value_type, BinaryOperation>(pool, first, last, result, op, 0);
+  }
+
+
+  /*! Computes the inclusive prefix sum of a sequence in parallel.
+  * \see parallel_inclusive_scan(Pool const &, RandomAccessIterator, RandomAccessIterator, OutputIterator, BinaryOperation const &)
+  */
+  template <typename Pool, typename RandomAccessIterator, typename OutputIterator>
+  OutputIterator parallel_inclusive_scan(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, OutputIterator result)
+  {
+    return parallel_inclusive_scan(pool, first, last, result, std::plus<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+  }
+
+
+  /*! Computes the exclusive prefix scan of a sequence in parallel: the i-th output is the combination of init and the first i inputs.
+  *  The calling thread participates.
+  * \param pool The pool whose workers scan the blocks.
+  * \param first The first element of the sequence.
+  * \param last The end of the sequence.
+  * \param result The first element of the output sequence. It may be equal to first.
+  * \param init The first output value.
+  * \param op An associative function object which implements 'Value operator()(Value const &, Value const &) const'.
+  * \return The end of the output sequence.
+  * \remarks The function object should not throw exceptions.
+  */
+  template <typename Pool, typename RandomAccessIterator, typename OutputIterator, typename Value, typename BinaryOperation>
+  OutputIterator parallel_exclusive_scan(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, OutputIterator result, Value const & init, BinaryOperation const & op)
+  {
+    return detail::parallel_scan<Pool, RandomAccessIterator, OutputIterator, Value, BinaryOperation>(pool, first, last, result, op, &init);
+  }
+
+
+  /*! Computes the exclusive prefix sum of a sequence in parallel.
+  * \see parallel_exclusive_scan(Pool const &, RandomAccessIterator, RandomAccessIterator, OutputIterator, Value const &, BinaryOperation const &)
+  */
+  template <typename Pool, typename RandomAccessIterator, typename OutputIterator, typename Value>
+  OutputIterator parallel_exclusive_scan(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, OutputIterator result, Value const & init)
+  {
+    return parallel_exclusive_scan(pool, first, last, result, init, std::plus<Value>());
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARALLEL_SCAN_HPP_INCLUDED
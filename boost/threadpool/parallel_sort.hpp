@@ -0,0 +1,222 @@
+/*! \file
+* \brief Parallel sorting.
+*
+* This file contains parallel_sort, a stable merge sort which sorts and
+* merges in parallel. Both halves of a merge are divided at the co-rank of
+* the output's midpoint, so the final merges are not limited to one thread.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARALLEL_SORT_HPP_INCLUDED
+#define THREADPOOL_PARALLEL_SORT_HPP_INCLUDED
+
+
+#include "fork_join.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /// Sequences which are not longer are sorted by std::stable_sort.
+    static std::size_t const sort_cutoff = 2048;
+
+    /// Merges whose output is not longer are performed by std::merge.
+    static std::size_t const merge_cutoff = 4096;
+
+
+    /*! Gets the number of elements of the first sequence which precede the k-th output element of a stable merge.
+    * \param first1 The first sequence.
+    * \param size1 The length of the first sequence.
+    * \param first2 The second sequence.
+    * \param size2 The length of the second sequence.
+    * \param k The output position, at most size1 + size2.
+    * \param comp The comparison.
+    * \return The co-rank i. The first k output elements are the first i elements of the first sequence and the first k - i of the second.
+    */
+    template <typename Iterator1, typename Iterator2, typename Compare>
+    std::size_t co_rank(Iterator1 first1, std::size_t const size1, Iterator2 first2, std::size_t const size2, std::size_t const k, Compare const & comp)
+    {
+      std::size_t low = k > size2 ? k - size2 : 0;
+      std::size_t high = k < size1 ? k : size1;
+      while(low < high)
+      {
+        std::size_t const i = low + (high - low) / 2;
+        std::size_t const j = k - i;
+        // equal elements of the first sequence precede those of the second
+        if(j > 0 && i < size1 && !comp(first2[j - 1], first1[i]))
+        {
+          low = i + 1;
+        }
+        else
+        {
+          high = i;
+        }
+      }
+      return low;
+    }
+
+
+    /*! \brief Merges two sorted sequences into an output sequence in parallel.
+    */
+    template <typename Pool, typename InputIterator, typename OutputIterator, typename Compare>
+    class parallel_merge_task
+    {
+      Pool const *      m_pool;
+      InputIterator     m_first1;
+      std::size_t       m_size1;
+      InputIterator     m_first2;
+      std::size_t       m_size2;
+      OutputIterator    m_result;
+      Compare const *   m_comp;
+
+    public:
+      typedef void result_type;
+
+      parallel_merge_task(Pool const & pool, InputIterator first1, std::size_t size1, InputIterator first2, std::size_t size2,
+                          OutputIterator result, Compare const & comp)
+        : m_pool(&pool)
+        , m_first1(first1)
+        , m_size1(size1)
+        , m_first2(first2)
+        , m_size2(size2)
+        , m_result(result)
+        , m_comp(&comp)
+      {
+      }
+
+      void operator()() const
+      {
+        std::size_t const size = m_size1 + m_size2;
+        if(size <= merge_cutoff)
+        {
+          std::merge(m_first1, m_first1 + m_size1, m_first2, m_first2 + m_size2, m_result, *m_comp);
+          return;
+        }
+
+        std::size_t const k = size / 2;
+        std::size_t const i = co_rank(m_first1, m_size1, m_first2, m_size2, k, *m_comp);
+        std::size_t const j = k - i;
+
+        parallel_invoke(*m_pool,
+          parallel_merge_task(*m_pool, m_first1, i, m_first2, j, m_result, *m_comp),
+          parallel_merge_task(*m_pool, m_first1 + i, m_size1 - i, m_first2 + j, m_size2 - j, m_result + k, *m_comp));
+      }
+    };
+
+
+    /*! \brief Sorts a sequence in parallel, using a buffer of the same length.
+    *
+    * The halves are sorted into the other sequence and merged back, so each level
+    * of the recursion moves the elements once.
+    */
+    template <typename Pool, typename Iterator, typename BufferIterator, typename Compare>
+    class parallel_sort_task
+    {
+      Pool const *      m_pool;
+      Iterator          m_first;
+      BufferIterator    m_buffer;
+      std::size_t       m_size;
+      bool              m_into_buffer;  // If true the sorted elements are stored in the buffer.
+      Compare const *   m_comp;
+
+    public:
+      typedef void result_type;
+
+      parallel_sort_task(Pool const & pool, Iterator first, BufferIterator buffer, std::size_t size, bool into_buffer, Compare const & comp)
+        : m_pool(&pool)
+        , m_first(first)
+        , m_buffer(buffer)
+        , m_size(size)
+        , m_into_buffer(into_buffer)
+        , m_comp(&comp)
+      {
+      }
+
+      void operator()() const
+      {
+        if(m_size <= sort_cutoff)
+        {
+          std::stable_sort(m_first, m_first + m_size, *m_comp);
+          if(m_into_buffer)
+          {
+            std::copy(m_first, m_first + m_size, m_buffer);
+          }
+          return;
+        }
+
+        std::size_t const half = m_size / 2;
+        parallel_invoke(*m_pool,
+          parallel_sort_task(*m_pool, m_first, m_buffer, half, !m_into_buffer, *m_comp),
+          parallel_sort_task(*m_pool, m_first + half, m_buffer + half, m_size - half, !m_into_buffer, *m_comp));
+
+        if(m_into_buffer)
+        {
+          parallel_merge_task<Pool, Iterator, BufferIterator, Compare>(*m_pool, m_first, half, m_first + half, m_size - half, m_buffer, *m_comp)();
+        }
+        else
+        {
+          parallel_merge_task<Pool, BufferIterator, Iterator, Compare>(*m_pool, m_buffer, half, m_buffer + half, m_size - half, m_first, *m_comp)();
+        }
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! Sorts a sequence in parallel. The sort is stable. The calling thread participates.
+  *  The sequence is divided recursively, short sequences are sorted sequentially and
+  *  the sorted parts are merged in parallel. A buffer with a copy of the sequence is allocated.
+  * \param pool The pool whose workers sort.
+  * \param first The first element of the sequence.
+  * \param last The end of the sequence.
+  * \param comp The strict weak ordering. It is called concurrently and should not throw exceptions.
+  * \remarks The elements must be CopyConstructible and Assignable.
+  */
+  template <typename Pool, typename RandomAccessIterator, typename Compare>
+  void parallel_sort(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last, Compare const & comp)
+  {
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+
+    std::size_t const size = static_cast<std::size_t>(last - first);
+    if(size <= detail::sort_cutoff)
+    {
+      std::stable_sort(first, last, comp);
+      return;
+    }
+
+    std::vector<value_type> buffer(first, last);
+    detail::parallel_sort_task<Pool, RandomAccessIterator, typename std::vector<value_type>::iterator, Compare>(
+      pool, first, buffer.begin(), size, false, comp)();
+  }
+
+
+  /*! Sorts a sequence in ascending order in parallel. The sort is stable.
+  * \see parallel_sort(Pool const &, RandomAccessIterator, RandomAccessIterator, Compare const &)
+  */
+  template <typename Pool, typename RandomAccessIterator>
+  void parallel_sort(Pool const & pool, RandomAccessIterator first, RandomAccessIterator last)
+  {
+    parallel_sort(pool, first, last, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARALLEL_SORT_HPP_INCLUDED
@@ -0,0 +1,300 @@
+/*! \file
+* \brief Ranges and partitioners for parallel algorithms.
+*
+* This file contains index_range, which describes the iteration space of
+* a parallel algorithm, and the partitioners which decide how a range is
+* divided into chunks: static_partitioner, simple_partitioner and
+* adaptive_partitioner.
+*
+* A Partitioner is CopyConstructible and provides:
+*
+* - template <typename Pool, typename Range> bool divide(Pool const & pool, Range & range, Range & upper, Partitioner & upper_partitioner):
+*   Splits off the upper part of range if it should be processed in parallel. Assigns the upper part
+*   and the partitioner for it. Returns false if range should not be divided (any further).
+* - template <typename Range> Range next_chunk(Range & range): Removes the next chunk which the
+*   calling thread processes from the front of range and returns it.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARTITIONERS_HPP_INCLUDED
+#define THREADPOOL_PARTITIONERS_HPP_INCLUDED
+
+
+#include "./detail/cache_padded.hpp"
+
+#include <cstddef>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Half-open range of indices [begin, end).
+  *
+  * A range is divided at multiples of its alignment only. If the elements
+  * of an array are processed and the array starts at a cache line boundary,
+  * an alignment of cache_line_elements<T>() keeps adjacent chunks on different
+  * cache lines, so workers writing to neighbouring chunks do not false-share.
+  *
+  * \param Index An integral type. The indices must not be negative.
+  */
+  template <typename Index = std::size_t>
+  class index_range
+  {
+    Index m_begin;
+    Index m_end;
+    Index m_alignment;
+
+  public:
+    typedef Index index_type;         //!< Indicates the index type.
+    typedef std::size_t size_type;    //!< Indicates the type of a range's size.
+
+    /// Constructs an empty range.
+    index_range()
+      : m_begin(0)
+      , m_end(0)
+      , m_alignment(1)
+    {
+    }
+
+    /*! Constructor.
+    * \param begin The first index.
+    * \param end The index after the last one.
+    * \param alignment Chunk boundaries are multiples of the alignment.
+    */
+    index_range(Index const begin, Index const end, Index const alignment = 1)
+      : m_begin(begin)
+      , m_end(end < begin ? begin : end)
+      , m_alignment(alignment > 0 ? alignment : 1)
+    {
+    }
+
+    Index begin() const       //!< Gets the first index.
+    {
+      return m_begin;
+    }
+
+    Index end() const         //!< Gets the index after the last one.
+    {
+      return m_end;
+    }
+
+    Index alignment() const   //!< Gets the alignment of chunk boundaries.
+    {
+      return m_alignment;
+    }
+
+    size_type size() const    //!< Gets the number of indices.
+    {
+      return static_cast<size_type>(m_end - m_begin);
+    }
+
+    bool empty() const        //!< Indicates that the range contains no index.
+    {
+      return m_begin == m_end;
+    }
+
+    /*! Indicates whether the range can be split in two non-empty halves.
+    * \return true, if an aligned index lies inside the range.
+    */
+    bool is_divisible() const
+    {
+      return aligned_point(m_begin + static_cast<Index>(size() / 2)) != m_begin;
+    }
+
+    /*! Splits the range. The range keeps its lower part.
+    * \param lower_size The preferred size of the lower part. The split point is rounded to the alignment.
+    * \return The upper part, which is empty if there is no aligned split point inside the range.
+    */
+    index_range split(size_type const lower_size)
+    {
+      Index const point = aligned_point(m_begin + static_cast<Index>(lower_size));
+      if(point == m_begin)
+      {
+        return index_range(m_end, m_end, m_alignment);
+      }
+
+      index_range upper(point, m_end, m_alignment);
+      m_end = point;
+      return upper;
+    }
+
+  private:
+    // Gets the aligned index next to the target which lies inside the range or begin if there is none.
+    Index aligned_point(Index const target) const
+    {
+      if(target <= m_begin || target >= m_end)
+      {
+        return m_begin;
+      }
+
+      Index point = target - target % m_alignment;
+      if(point <= m_begin)
+      {
+        point += m_alignment;
+      }
+      return point < m_end ? point : m_begin;
+    }
+  };
+
+
+  /*! Gets the number of array elements which fill one cache line.
+  * \return The alignment for ranges which index arrays of T.
+  */
+  template <typename T>
+  std::size_t cache_line_elements()
+  {
+    return sizeof(T) < detail::cache_line_size ? detail::cache_line_size / sizeof(T) : 1;
+  }
+
+
+  /*! \brief Divides a range into one chunk per worker.
+  *
+  * The chunks are created up front and have equal size. This is the right
+  * choice for uniform iterations on a pool which is not shared with other work.
+  */
+  class static_partitioner
+  {
+    std::size_t m_chunks;   // Number of chunks the range is divided into, 0 until the pool's size is known.
+
+  public:
+    /// Constructor.
+    static_partitioner()
+      : m_chunks(0)
+    {
+    }
+
+    template <typename Pool, typename Range>
+    bool divide(Pool const & pool, Range & range, Range & upper, static_partitioner & upper_partitioner)
+    {
+      if(m_chunks == 0)
+      {
+        m_chunks = pool.size() > 0 ? pool.size() : 1;
+      }
+
+      if(m_chunks < 2 || !range.is_divisible())
+      {
+        return false;
+      }
+
+      std::size_t const lower_chunks = m_chunks - m_chunks / 2;
+      std::size_t const size = range.size();
+      upper = range.split(size / m_chunks * lower_chunks + size % m_chunks * lower_chunks / m_chunks);
+      if(upper.empty())
+      {
+        return false;
+      }
+
+      upper_partitioner.m_chunks = m_chunks - lower_chunks;
+      m_chunks = lower_chunks;
+      return true;
+    }
+
+    template <typename Range>
+    Range next_chunk(Range & range)
+    {
+      Range chunk(range);
+      range = Range(range.end(), range.end(), range.alignment());
+      return chunk;
+    }
+  };
+
+
+  /*! \brief Divides a range into chunks of a fixed maximum size.
+  *
+  * The range is halved recursively until the chunks are not larger than
+  * the grain size, independent of the pool's load.
+  */
+  class simple_partitioner
+  {
+    std::size_t m_grain_size;
+
+  public:
+    /*! Constructor.
+    * \param grain_size The maximum number of indices per chunk.
+    */
+    explicit simple_partitioner(std::size_t const grain_size = 1)
+      : m_grain_size(grain_size > 0 ? grain_size : 1)
+    {
+    }
+
+    template <typename Pool, typename Range>
+    bool divide(Pool const &, Range & range, Range & upper, simple_partitioner & upper_partitioner)
+    {
+      if(range.size() <= m_grain_size)
+      {
+        return false;
+      }
+
+      upper = range.split(range.size() / 2);
+      upper_partitioner = *this;
+      return !upper.empty();
+    }
+
+    template <typename Range>
+    Range next_chunk(Range & range)
+    {
+      Range chunk(range);
+      range = Range(range.end(), range.end(), range.alignment());
+      return chunk;
+    }
+  };
+
+
+  /*! \brief Divides a range lazily while workers are idle.
+  *
+  * The calling thread processes the range chunk by chunk from the front. Before
+  * each chunk it splits off the upper half for other workers, but only if a worker
+  * of the pool is idle. The chunks shrink towards the end of the range so that
+  * late idle workers still find work to take over. On a busy pool the range is
+  * processed with few splits and little scheduling overhead.
+  */
+  class adaptive_partitioner
+  {
+    std::size_t m_grain_size;
+
+  public:
+    /*! Constructor.
+    * \param grain_size The minimum number of indices per chunk.
+    */
+    explicit adaptive_partitioner(std::size_t const grain_size = 1)
+      : m_grain_size(grain_size > 0 ? grain_size : 1)
+    {
+    }
+
+    template <typename Pool, typename Range>
+    bool divide(Pool const & pool, Range & range, Range & upper, adaptive_partitioner & upper_partitioner)
+    {
+      if(range.size() < 2 * m_grain_size || pool.active() + pool.pending() >= pool.size())
+      {
+        return false;
+      }
+
+      upper = range.split(range.size() / 2);
+      upper_partitioner = *this;
+      return !upper.empty();
+    }
+
+    template <typename Range>
+    Range next_chunk(Range & range)
+    {
+      std::size_t const chunk_size = range.size() / 8;
+      Range upper = range.split(chunk_size > m_grain_size ? chunk_size : m_grain_size);
+      Range chunk(range);
+      range = upper;
+      return chunk;
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARTITIONERS_HPP_INCLUDED
@@ -0,0 +1,367 @@
+/*! \file
+* \brief Bounded parallel pipeline.
+*
+* This file contains the pipeline class, a sequence of stages which process
+* a stream of items, and parallel_pipeline, which executes a pipeline on a
+* pool. A stage is either parallel, or serial in or out of the input order.
+* The number of items in flight is limited by a token count.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PIPELINE_HPP_INCLUDED
+#define THREADPOOL_PIPELINE_HPP_INCLUDED
+
+
+#include "task_group.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Stage of a pipeline.
+  *
+  * A stage transforms an item into the item for the next stage. Items are passed
+  * as untyped pointers; their ownership is defined by the stages. The first stage
+  * of a pipeline is the input: it is called with a null pointer and returns the
+  * next item or null at the end of the stream. It is never called concurrently.
+  *
+  * \see pipeline, parallel_pipeline
+  */
+  class pipeline_stage
+  {
+  public:
+    /// Determines how the items pass a stage.
+    enum mode
+    {
+      parallel,               //!< Several items are processed concurrently in any order.
+      serial_in_order,        //!< One item at a time in the order the input stage produced them.
+      serial_out_of_order     //!< One item at a time in any order.
+    };
+
+  private:
+    mode const m_mode;
+
+  public:
+    /*! Constructor.
+    * \param stage_mode Determines how the items pass the stage.
+    */
+    explicit pipeline_stage(mode const stage_mode)
+      : m_mode(stage_mode)
+    {
+    }
+
+    /// Destructor.
+    virtual ~pipeline_stage()
+    {
+    }
+
+    /*! Gets how the items pass the stage.
+    * \return The stage's mode.
+    */
+    mode stage_mode() const
+    {
+      return m_mode;
+    }
+
+    /*! Processes an item. Should not throw exceptions.
+    * \param item The item produced by the previous stage, null for the input stage.
+    * \return The item for the next stage.
+    */
+    virtual void* operator()(void* item) = 0;
+  };
+
+
+  /*! \brief Sequence of pipeline stages.
+  *
+  * The pipeline does not own its stages.
+  */
+  class pipeline
+  : private noncopyable
+  {
+    std::vector<pipeline_stage*> m_stages;
+
+  public:
+    /*! Appends a stage. The first stage is the input stage.
+    * \param stage The stage which must outlive the pipeline's execution.
+    */
+    void add_stage(pipeline_stage & stage)
+    {
+      m_stages.push_back(&stage);
+    }
+
+    /*! Removes all stages.
+    */
+    void clear()
+    {
+      m_stages.clear();
+    }
+
+    /*! Gets the number of stages.
+    * \return The number of stages.
+    */
+    std::size_t size() const
+    {
+      return m_stages.size();
+    }
+
+    /*! Gets a stage.
+    * \param index The stage's index.
+    * \return The stage.
+    */
+    pipeline_stage & stage(std::size_t const index) const
+    {
+      return *m_stages[index];
+    }
+  };
+
+
+  namespace detail
+  {
+    /// Item which passes the pipeline together with its input position.
+    struct pipeline_token
+    {
+      void*         item;
+      std::size_t   sequence;
+    };
+
+
+    /*! \brief Admission of tokens to a serial stage.
+    */
+    class serial_stage_gate
+    : private noncopyable
+    {
+      bool const                                    m_in_order;
+      mutex                                         m_monitor;
+      bool                                          m_busy;
+      std::size_t                                   m_next_sequence;  // Used if the order is kept.
+      std::map<std::size_t, pipeline_token>         m_waiting;        // Tokens which could not enter.
+
+    public:
+      explicit serial_stage_gate(bool const in_order)
+        : m_in_order(in_order)
+        , m_busy(false)
+        , m_next_sequence(0)
+      {
+      }
+
+      // Lets the token enter the stage or keeps it until the stage is released.
+      bool enter(pipeline_token const & token)
+      {
+        mutex::scoped_lock lock(m_monitor);
+        if(!m_busy && (!m_in_order || token.sequence == m_next_sequence))
+        {
+          m_busy = true;
+          return true;
+        }
+
+        m_waiting.insert(std::make_pair(token.sequence, token));
+        return false;
+      }
+
+      // Releases the stage. If a waiting token may enter now the stage is handed over to it.
+      bool release(pipeline_token & next)
+      {
+        mutex::scoped_lock lock(m_monitor);
+        ++m_next_sequence;
+
+        std::map<std::size_t, pipeline_token>::iterator it = m_in_order ? m_waiting.find(m_next_sequence) : m_waiting.begin();
+        if(it == m_waiting.end())
+        {
+          m_busy = false;
+          return false;
+        }
+
+        next = it->second;
+        m_waiting.erase(it);
+        return true;
+      }
+    };
+
+
+    /*! \brief Execution of a pipeline on a pool.
+    *
+    * Each task carries its token through all stages. If a serial stage is
+    * occupied the token waits at the stage and the task reads the next input
+    * item instead. The task which releases the stage resumes the waiting token
+    * in a new task. When a token leaves the last stage its task reads the next
+    * input item, so the items stay on one worker while they pass the stages.
+    */
+    template <typename Pool>
+    class pipeline_execution
+    : private noncopyable
+    {
+      typedef pipeline_execution<Pool> execution_type;
+
+      pipeline const &                              m_pipeline;
+      std::vector<shared_ptr<serial_stage_gate> >   m_gates;          // Null for parallel stages.
+      std::size_t const                             m_max_tokens;
+      task_group<Pool>                              m_tasks;
+
+      mutex                                         m_input_monitor;
+      bool                                          m_input_busy;
+      bool                                          m_input_done;
+      std::size_t                                   m_tokens;         // Number of tokens in flight.
+      std::size_t                                   m_next_sequence;
+
+      /// Task which resumes a token or reads input.
+      class task
+      {
+        execution_type*   m_execution;
+        pipeline_token    m_token;
+        std::size_t       m_stage;      // The stage the token has entered, 0 if the task reads input.
+
+      public:
+        typedef void result_type;
+
+        task(execution_type & execution, pipeline_token const & token, std::size_t const stage)
+          : m_execution(&execution)
+          , m_token(token)
+          , m_stage(stage)
+        {
+        }
+
+        void operator()() const
+        {
+          m_execution->execute(m_token, m_stage);
+        }
+      };
+
+    public:
+      pipeline_execution(Pool const & pool, pipeline const & stages, std::size_t const max_tokens)
+        : m_pipeline(stages)
+        , m_max_tokens(max_tokens > 0 ? max_tokens : 1)
+        , m_tasks(pool)
+        , m_input_busy(false)
+        , m_input_done(false)
+        , m_tokens(0)
+        , m_next_sequence(0)
+      {
+        for(std::size_t i = 0; i < stages.size(); ++i)
+        {
+          pipeline_stage::mode const mode = stages.stage(i).stage_mode();
+          m_gates.push_back(shared_ptr<serial_stage_gate>(
+            i > 0 && mode != pipeline_stage::parallel ? new serial_stage_gate(mode == pipeline_stage::serial_in_order) : 0));
+        }
+      }
+
+      void run()
+      {
+        pipeline_token const none = { 0, 0 };
+        execute(none, 0);
+        m_tasks.wait();
+      }
+
+      // Processes the token from the stage it has entered, then reads input while the token limit permits.
+      void execute(pipeline_token token, std::size_t const stage)
+      {
+        if(stage > 0)
+        {
+          process(token, stage, true);
+        }
+
+        while(read_input(token))
+        {
+          process(token, 1, false);
+        }
+      }
+
+    private:
+      bool read_input(pipeline_token & token)
+      {
+        {
+          mutex::scoped_lock lock(m_input_monitor);
+          if(m_input_busy || m_input_done || m_tokens >= m_max_tokens)
+          {
+            return false;
+          }
+          m_input_busy = true;
+          ++m_tokens;
+          token.sequence = m_next_sequence++;
+        }
+
+        token.item = m_pipeline.size() > 0 ? m_pipeline.stage(0)(0) : 0;
+
+        mutex::scoped_lock lock(m_input_monitor);
+        m_input_busy = false;
+        if(!token.item)
+        {
+          m_input_done = true;
+          --m_tokens;
+          return false;
+        }
+
+        // let another worker read the next item while this one processes the current item
+        if(m_tokens < m_max_tokens)
+        {
+          pipeline_token const none = { 0, 0 };
+          m_tasks.run(task(*this, none, 0));
+        }
+        return true;
+      }
+
+      // Carries the token through the stages until it leaves the pipeline or waits at a serial stage.
+      void process(pipeline_token token, std::size_t stage, bool entered)
+      {
+        for(; stage < m_pipeline.size(); ++stage)
+        {
+          serial_stage_gate* const gate = m_gates[stage].get();
+          if(gate && !entered && !gate->enter(token))
+          {
+            return; // resumed by the token which releases the stage
+          }
+          entered = false;
+
+          token.item = m_pipeline.stage(stage)(token.item);
+
+          pipeline_token next;
+          if(gate && gate->release(next))
+          {
+            task const resume(*this, next, stage);
+            if(!m_tasks.run(resume))
+            { // the pool is full or terminated, the token must not be lost
+              resume();
+            }
+          }
+        }
+
+        mutex::scoped_lock lock(m_input_monitor);
+        --m_tokens;
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! Executes a pipeline. The calling thread participates and the function returns when all items passed all stages.
+  * \param pool The pool whose workers process the items.
+  * \param max_tokens The maximum number of items in flight. The input stage is not called while the limit is reached.
+  * \param stages The pipeline.
+  * \remarks The pool's task type must be constructible from a nullary function object.
+  */
+  template <typename Pool>
+  void parallel_pipeline(Pool const & pool, std::size_t const max_tokens, pipeline const & stages)
+  {
+    detail::pipeline_execution<Pool>(pool, stages, max_tokens).run();
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PIPELINE_HPP_INCLUDED
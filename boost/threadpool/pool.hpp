@@ -26,13 +26,17 @@
 
 #include "./detail/pool_core.hpp"
 
+#include "intrusive_task.hpp"
 #include "task_adaptors.hpp"
+#include "unique_task.hpp"
 
 #include "./detail/locking_ptr.hpp"
 
+#include "scheduler_traits.hpp"
 #include "scheduling_policies.hpp"
 #include "size_policies.hpp"
 #include "shutdown_policies.hpp"
+#include "idle_policies.hpp"
 
 
 
@@ -40,6 +44,18 @@
 namespace boost { namespace threadpool
 {
 
+  /*! \brief Default task type of the pools.
+  *
+  * The move-only unique_task if the compiler supports rvalue references,
+  * task_func otherwise.
+  *
+  */ 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  typedef unique_task default_task;
+#else
+  typedef task_func default_task;
+#endif
+
 
 
   /*! \brief Thread pool. 
@@ -55,20 +71,23 @@ namespace boost { namespace threadpool
   * All operations on a pool except assignment are strongly thread safe or sequentially consistent; 
   * that is, the behavior of concurrent calls is as if the calls have been issued sequentially in an unspecified order.
   *
-  * \param Task A function object which implements the operator 'void operator() (void) const'. The operator () is called by the pool to execute the task. Exceptions are ignored.
-  * \param SchedulingPolicy A task container which determines how tasks are scheduled. It is guaranteed that this container is accessed only by one thread at a time. The scheduler shall not throw exceptions.
+  * \param Task A function object which implements the operator 'void operator() (void) const'. The operator () is called by the pool to execute the task. Exceptions are ignored. The pool stores the task type itself; the bundled schedulers require it to be DefaultConstructible.
+  * \param SchedulingPolicy A task container which determines how tasks are scheduled. It is guaranteed that this container is accessed only by one thread at a time unless it is a concurrent scheduler (see is_concurrent_scheduler). The scheduler shall not throw exceptions.
+  * \param IdlePolicy Determines what a worker does before it blocks because no task is available. Each worker owns a separate instance.
   *
   * \remarks The pool class is thread-safe.
   * 
-  * \see Tasks: task_func, prio_task_func
-  * \see Scheduling policies: fifo_scheduler, lifo_scheduler, prio_scheduler
+  * \see Tasks: default_task, unique_task, task_func, prio_task_func
+  * \see Scheduling policies: fifo_scheduler, lifo_scheduler, prio_scheduler, bounded_fifo_scheduler, work_stealing_scheduler
+  * \see Idle policies: block_when_idle, spin_then_park, busy_poll
   */ 
   template <
-    typename Task                                   = task_func,
+    typename Task                                   = default_task,
     template <typename> class SchedulingPolicy      = fifo_scheduler,
     template <typename> class SizePolicy            = static_size,
     template <typename> class SizePolicyController  = resize_controller,
-    template <typename> class ShutdownPolicy        = wait_for_all_tasks
+    template <typename> class ShutdownPolicy        = wait_for_all_tasks,
+    template <typename> class IdlePolicy            = block_when_idle
   > 
   class thread_pool 
   {
@@ -76,7 +95,8 @@ namespace boost { namespace threadpool
                               SchedulingPolicy,
                               SizePolicy,
                               SizePolicyController,
-                              ShutdownPolicy> pool_core_type;
+                              ShutdownPolicy,
+                              IdlePolicy> pool_core_type;
     shared_ptr<pool_core_type>          m_core; // pimpl idiom
     shared_ptr<void>                    m_shutdown_controller; // If the last pool holding a pointer to the core is deleted the controller shuts the pool down.
 
@@ -90,6 +110,7 @@ namespace boost { namespace threadpool
  */
     typedef SizePolicy<pool_core_type> size_policy_type; 
     typedef SizePolicyController<pool_core_type> size_controller_type;
+    typedef IdlePolicy<pool_core_type> idle_policy_type;      //!< Indicates the idle policy's type.
 
 
   public:
@@ -133,8 +154,127 @@ namespace boost { namespace threadpool
      }
 
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+     /*! Schedules a task for asynchronous execution. The task is moved into the pool.
+     * \param task The task function object. It should not throw execeptions.
+     * \return true, if the task could be scheduled and false otherwise. 
+     */  
+     bool schedule(task_type && task)
+     {	
+       return m_core->schedule(boost::move(task));
+     }
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+     /*! Constructs a task in place in the scheduler and schedules it for asynchronous execution.
+     *  For example, prio_pool::emplace(priority, function) creates the prio_task_func in the scheduler's storage.
+     * \param args The arguments of the task's constructor.
+     * \return true, if the task could be scheduled and false otherwise. 
+     */  
+     template <typename... Args>
+     bool emplace(Args &&... args)
+     {	
+       return m_core->emplace(std::forward<Args>(args)...);
+     }
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+     /*! Schedules the call of a function with arguments for asynchronous execution. The call
+     *  is stored in the task without a bind expression or further allocations.
+     * \param function The function object, function pointer or member function pointer. It should not throw execeptions.
+     * \param arg The first argument, for a member function the object or a pointer to it.
+     * \param args The further arguments. All arguments are copied or moved into the task.
+     * \return true, if the task could be scheduled and false otherwise. 
+     * \remarks The function's result is discarded. The task type must be constructible from deferred_call.
+     */  
+     template <typename Function, typename Arg, typename... Args>
+     bool schedule(Function && function, Arg && arg, Args &&... args)
+     {	
+       return m_core->emplace(make_deferred_call(std::forward<Function>(function), std::forward<Arg>(arg), std::forward<Args>(args)...));
+     }
+#endif
+
+
+     /*! Schedules the tasks of a range for asynchronous execution. All tasks are 
+     *  enqueued at once and at most as many idle workers are woken up as there are new tasks.
+     * \param first The first task of the range.
+     * \param last The end of the range.
+     * \return The number of scheduled tasks. The scheduling stops at the first task which cannot be scheduled.
+     */  
+     template <typename InputIterator>
+     size_t schedule_bulk(InputIterator first, InputIterator last)
+     {	
+       return m_core->schedule_bulk(first, last);
+     }
+
+
+     /*! Schedules the tasks generator(0), ..., generator(count - 1) for asynchronous execution.
+     *  All tasks are enqueued at once and at most count idle workers are woken up.
+     * \param count The number of tasks.
+     * \param generator A function object which is called with the task index and returns a task.
+     * \return The number of scheduled tasks. The scheduling stops at the first task which cannot be scheduled.
+     */  
+     template <typename Generator>
+     size_t schedule_n(size_t const count, Generator generator)
+     {	
+       return m_core->schedule_n(count, generator);
+     }
+
+
+    /*! Sets the maximum number of tasks a worker removes from the scheduler with one 
+    *  lock acquisition. Batching reduces the locking overhead of very short tasks. 
+    *  The batch adapts to the number of pending tasks so that a worker never takes 
+    *  more than its share while other workers are idle. Batching is disabled by default.
+    * \param max_tasks The maximum batch size. 0 and 1 disable batching.
+    * \remarks Concurrent schedulers are not accessed under a lock and are never dequeued in batches.
+    *  Tasks in a batch are counted as pending until the worker starts them, so wait() 
+    *  and pending() are not affected. clear() discards them.
+    */  
+    void set_dequeue_batch_size(size_t const max_tasks)
+    {
+      m_core->set_dequeue_batch_size(max_tasks);
+    }
+
+
+    /*! Gets the maximum number of tasks a worker removes from the scheduler at once.
+    * \return The maximum batch size.
+    */  
+    size_t dequeue_batch_size() const
+    {
+      return m_core->dequeue_batch_size();
+    }
+
+
+    /*! Binds the workers which are started afterwards to the given processors.
+    *  The processors are assigned round-robin in the order the workers start. 
+    *  Workers which are already running are not affected, so the processors should
+    *  be set before the pool is resized. Binding is supported on Linux and Windows.
+    * \param cpus The zero-based processor indices. An empty list disables binding.
+    * \see busy_poll
+    */  
+    void set_worker_cpus(std::vector<unsigned int> const & cpus)
+    {
+      m_core->set_worker_cpus(cpus);
+    }
+
+
+    /*! Terminates all workers and releases their processors. Active tasks are completed, 
+    *  pending tasks are discarded. Afterwards the pool cannot be resized, schedule() and 
+    *  emplace() return false, schedule_bulk() and schedule_n() return 0 and wait() only 
+    *  waits for the active tasks.
+    * \remarks Must not be called by a task of the pool.
+    */  
+    void stop()
+    {
+      m_core->stop();
+    }
+
+
     /*! Returns the number of tasks which are currently executed.
     * \return The number of active tasks. 
+    * \remarks The function does not lock. The result is only a snapshot.
     */  
     size_t active() const
     {
@@ -144,6 +284,7 @@ namespace boost { namespace threadpool
 
     /*! Returns the number of tasks which are ready for execution.    
     * \return The number of pending tasks. 
+    * \remarks The function does not lock. The result is only a snapshot.
     */  
     size_t pending() const
     {
@@ -196,18 +337,18 @@ namespace boost { namespace threadpool
 
   /*! \brief Fifo pool.
   *
-  * The pool's tasks are fifo scheduled task_func functors.
+  * The pool's tasks are fifo scheduled default_task functors.
   *
   */ 
-  typedef thread_pool<task_func, fifo_scheduler, static_size, resize_controller, wait_for_all_tasks> fifo_pool;
+  typedef thread_pool<default_task, fifo_scheduler, static_size, resize_controller, wait_for_all_tasks> fifo_pool;
 
 
   /*! \brief Lifo pool.
   *
-  * The pool's tasks are lifo scheduled task_func functors.
+  * The pool's tasks are lifo scheduled default_task functors.
   *
   */ 
-  typedef thread_pool<task_func, lifo_scheduler, static_size, resize_controller, wait_for_all_tasks> lifo_pool;
+  typedef thread_pool<default_task, lifo_scheduler, static_size, resize_controller, wait_for_all_tasks> lifo_pool;
 
 
   /*! \brief Pool for prioritized task.
@@ -218,9 +359,37 @@ namespace boost { namespace threadpool
   typedef thread_pool<prio_task_func, prio_scheduler, static_size, resize_controller, wait_for_all_tasks> prio_pool;
 
 
+  /*! \brief Bounded lock-free fifo pool.
+  *
+  * The pool's tasks are fifo scheduled default_task functors. The number of pending 
+  * tasks is limited, scheduling fails if the pool is full.
+  *
+  */ 
+  typedef thread_pool<default_task, bounded_fifo_scheduler, static_size, resize_controller, wait_for_all_tasks> bounded_fifo_pool;
+
+
+  /*! \brief Work-stealing pool.
+  *
+  * The pool's tasks are default_task functors. Each worker processes the tasks it
+  * scheduled itself in lifo order and steals tasks from other workers when idle.
+  *
+  */ 
+  typedef thread_pool<default_task, work_stealing_scheduler, static_size, resize_controller, wait_for_all_tasks> work_stealing_pool;
+
+
+  /*! \brief Intrusive fifo pool.
+  *
+  * The pool's tasks are objects derived from intrusive_task_hook. They are linked 
+  * into a lock-free fifo queue without copying or allocation and remain owned 
+  * by the caller.
+  *
+  */ 
+  typedef thread_pool<intrusive_task, intrusive_fifo_scheduler, static_size, resize_controller, wait_for_all_tasks> intrusive_pool;
+
+
   /*! \brief A standard pool.
   *
-  * The pool's tasks are fifo scheduled task_func functors.
+  * The pool's tasks are fifo scheduled default_task functors.
   *
   */ 
   typedef fifo_pool pool;
@@ -19,11 +19,57 @@
 #define THREADPOOL_POOL_ADAPTORS_HPP_INCLUDED
 
 #include <boost/smart_ptr.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/mpl/bool.hpp>
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+#include <utility>
+#endif
 
 
 namespace boost { namespace threadpool
 {
 
+  namespace detail
+  {
+    /// Task which calls the run() member function of a shared Runnable.
+    template <typename Runnable>
+    class runnable_task
+    {
+      shared_ptr<Runnable> m_runnable;
+
+    public:
+      typedef void result_type;
+
+      explicit runnable_task(shared_ptr<Runnable> const & runnable)
+        : m_runnable(runnable)
+      {
+      }
+
+      void operator()() const
+      {
+        m_runnable->run();
+      }
+    };
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! \brief Checks if a pool provides the member function schedule(function, args...) for the given arguments.
+    */
+    template <typename Pool, typename... Args>
+    class has_variadic_schedule
+    {
+      template <typename T> static char test(decltype(std::declval<T&>().schedule(std::declval<Args>()...))*);
+      template <typename T> static long test(...);
+
+    public:
+      static bool const value = sizeof(test<Pool>(0)) == sizeof(char);
+      typedef mpl::bool_<value> type;
+    };
+#endif
+
+  } // namespace detail
+
 
 // TODO convenience scheduling function
     /*! Schedules a Runnable for asynchronous execution. A Runnable is an arbitrary class with a run()
@@ -35,7 +81,7 @@ namespace boost { namespace threadpool
     template<typename Pool, typename Runnable>
     bool schedule(Pool& pool, shared_ptr<Runnable> const & obj)
     {	
-      return pool->schedule(bind(&Runnable::run, obj));
+      return pool.schedule(detail::runnable_task<Runnable>(obj));
     }	
     
     /*! Schedules a task for asynchronous execution. The task will be executed once only.
@@ -63,6 +109,55 @@ namespace boost { namespace threadpool
     }	
 
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Schedules a task for asynchronous execution. The task is moved into the pool.
+    * \param task The task function object.
+    */  
+    template<typename Pool>
+    typename enable_if < 
+      is_void< typename result_of< typename Pool::task_type() >::type >,
+      bool
+    >::type
+    schedule(Pool& pool, typename Pool::task_type && task)
+    {	
+      return pool.schedule(boost::move(task));
+    }	
+
+
+    template<typename Pool>
+    typename enable_if < 
+      is_void< typename result_of< typename Pool::task_type() >::type >,
+      bool
+    >::type
+    schedule(shared_ptr<Pool> const pool, typename Pool::task_type && task)
+    {	
+      return pool->schedule(boost::move(task));
+    }	
+#endif
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Schedules the call of a function with arguments for asynchronous execution. 
+    *  This is a shorthand for pool.schedule(function, arg, args...), no bind expression is created.
+    * \param function The function object, function pointer or member function pointer.
+    * \param arg The first argument, for a member function the object or a pointer to it.
+    * \param args The further arguments. All arguments are copied or moved into the task.
+    * \return true, if the task could be scheduled and false otherwise. 
+    * \remarks Use schedule(pool, function) to obtain a future of a function's result. The overload
+    *  only participates in overload resolution if the pool provides schedule(function, arg, args...).
+    */  
+    template<typename Pool, typename Function, typename Arg, typename... Args>
+    typename enable_if < 
+      detail::has_variadic_schedule<Pool, Function, Arg, Args...>,
+      bool
+    >::type
+    schedule(Pool& pool, Function && function, Arg && arg, Args &&... args)
+    {	
+      return pool.schedule(std::forward<Function>(function), std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }	
+#endif
+
+
 } } // namespace boost::threadpool
 
 #endif // THREADPOOL_POOL_ADAPTORS_HPP_INCLUDED
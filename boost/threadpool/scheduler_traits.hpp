@@ -0,0 +1,128 @@
+/*! \file
+* \brief Scheduler traits.
+*
+* This file contains the traits which tell the pool how a scheduling policy
+* has to be accessed.
+*
+* By default the pool serializes all accesses to its scheduler. A concurrent
+* scheduler is thread-safe on its own and the pool uses it without locking.
+* In addition to the requirements of a SchedulingPolicy it provides:
+*
+* - bool try_pop(task_type & task): Removes the next task and assigns it to task.
+*   Returns false if no task was available.
+* - push(), size(), empty() and clear() may be called by any thread at any time.
+*   size() and empty() may return snapshots.
+* - Optionally void attach_worker() and void detach_worker(), which are called by
+*   each worker thread when it starts and when it terminates.
+* - The task type must be DefaultConstructible.
+*
+* A scheduler is marked as concurrent by declaring the type concurrent_scheduler_tag
+* or by specializing is_concurrent_scheduler.
+*
+* A sequential scheduler may provide void pop(task_type & task), which removes the
+* next task and moves it into task. The pool uses it instead of copying top(), the
+* task type must be DefaultConstructible then.
+*
+* Any scheduler may provide bool push(task_type && task), which moves the task into
+* the scheduler, and bool emplace(Args &&... args), which constructs the task in
+* place. Without emplace() the pool constructs a temporary task and pushes it.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_SCHEDULER_TRAITS_HPP_INCLUDED
+#define THREADPOOL_SCHEDULER_TRAITS_HPP_INCLUDED
+
+
+#include <boost/config.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/has_xxx.hpp>
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+#include <utility>
+#endif
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF(has_concurrent_scheduler_tag, concurrent_scheduler_tag, false)
+
+
+    /*! \brief Checks if a scheduler provides the member functions attach_worker() and detach_worker().
+    */
+    template <typename Scheduler>
+    class has_worker_hooks
+    {
+      template <typename T, void (T::*)(), void (T::*)()> struct check;
+
+      template <typename T> static char test(check<T, &T::attach_worker, &T::detach_worker>*);
+      template <typename T> static long test(...);
+
+    public:
+      static bool const value = sizeof(test<Scheduler>(0)) == sizeof(char);
+      typedef mpl::bool_<value> type;
+    };
+
+
+    /*! \brief Checks if a scheduler provides the member function pop(task_type &), which moves the next task out.
+    */
+    template <typename Scheduler>
+    class has_task_pop
+    {
+      template <typename T, void (T::*)(typename T::task_type &)> struct check;
+
+      template <typename T> static char test(check<T, &T::pop>*);
+      template <typename T> static long test(...);
+
+    public:
+      static bool const value = sizeof(test<Scheduler>(0)) == sizeof(char);
+      typedef mpl::bool_<value> type;
+    };
+
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! \brief Checks if a scheduler provides the member function template emplace(), which constructs a task in place.
+    */
+    template <typename Scheduler>
+    class has_emplace
+    {
+      template <typename T> static char test(decltype(std::declval<T&>().emplace(std::declval<typename T::task_type>()))*);
+      template <typename T> static long test(...);
+
+    public:
+      static bool const value = sizeof(test<Scheduler>(0)) == sizeof(char);
+      typedef mpl::bool_<value> type;
+    };
+#endif
+
+  } // namespace detail
+
+
+  /*! \brief Indicates whether a scheduling policy is thread-safe on its own.
+  *
+  * The trait is true for schedulers which declare the type concurrent_scheduler_tag.
+  * It may be specialized for third-party schedulers which cannot be modified.
+  *
+  * \param Scheduler The scheduling policy's type.
+  */
+  template <typename Scheduler>
+  struct is_concurrent_scheduler
+  : mpl::bool_<detail::has_concurrent_scheduler_tag<Scheduler>::value>
+  {
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_SCHEDULER_TRAITS_HPP_INCLUDED
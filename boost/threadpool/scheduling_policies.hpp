@@ -6,7 +6,8 @@
 * the tasks. 	Fundamentally the container determines the order the tasks are processed
 * by the thread pool. 
 * The task containers need not to be thread-safe because they are used by the pool 
-* in thread-safe way. 
+* in thread-safe way. Concurrent schedulers are thread-safe on their own and are
+* accessed by the pool without locking, see scheduler_traits.hpp.
 *
 * Copyright (c) 2005-2007 Philipp Henkel
 *
@@ -23,14 +24,52 @@
 #define THREADPOOL_SCHEDULING_POLICIES_HPP_INCLUDED
 
 
+#include <algorithm>
 #include <queue>
 #include <deque>
+#include <new>
+#include <utility>
 
+#include <boost/atomic.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/utility.hpp>
+
+#include "intrusive_task.hpp"
+#include "scheduler_traits.hpp"
 #include "task_adaptors.hpp"
+#include "./detail/intrusive_mpsc_queue.hpp"
+#include "./detail/mpmc_ring_buffer.hpp"
+#include "./detail/thread_local_ptr.hpp"
+#include "./detail/work_stealing_deque.hpp"
 
 namespace boost { namespace threadpool
 {
 
+  namespace detail
+  {
+    /*! \brief Priority queue whose top element can be moved out while it is removed.
+    */
+    template <typename T>
+    class priority_task_queue
+    : public std::priority_queue<T>
+    {
+    public:
+      using std::priority_queue<T>::pop;
+
+      void pop(T & top)
+      {
+        std::pop_heap(this->c.begin(), this->c.end(), this->comp);
+        top = boost::move(this->c.back());
+        this->c.pop_back();
+      }
+    };
+
+  } // namespace detail
+
+
   /*! \brief SchedulingPolicy which implements FIFO ordering. 
   *
   * This container implements a FIFO scheduling policy.
@@ -62,6 +101,31 @@ namespace boost { namespace threadpool
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler. The task is moved into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      m_container.push_back(boost::move(task));
+      return true;
+    }
+#endif
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a new task in place in the scheduler.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      m_container.emplace_back(std::forward<Args>(args)...);
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -69,6 +133,16 @@ namespace boost { namespace threadpool
       m_container.pop_front();
     }
 
+    /*! Removes the task which should be executed next and moves it into the given object.
+    * \param task Receives the task object.
+    * \remarks The scheduler must not be empty.
+    */
+    void pop(task_type & task)
+    {
+      task = boost::move(m_container.front());
+      m_container.pop_front();
+    }
+
     /*! Gets the task which should be executed next.
     *  \return The task object to be executed.
     */
@@ -134,6 +208,31 @@ namespace boost { namespace threadpool
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler. The task is moved into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      m_container.push_front(boost::move(task));
+      return true;
+    }
+#endif
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a new task in place in the scheduler.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      m_container.emplace_front(std::forward<Args>(args)...);
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -141,6 +240,16 @@ namespace boost { namespace threadpool
       m_container.pop_front();
     }
 
+    /*! Removes the task which should be executed next and moves it into the given object.
+    * \param task Receives the task object.
+    * \remarks The scheduler must not be empty.
+    */
+    void pop(task_type & task)
+    {
+      task = boost::move(m_container.front());
+      m_container.pop_front();
+    }
+
     /*! Gets the task which should be executed next.
     *  \return The task object to be executed.
     */
@@ -196,7 +305,7 @@ namespace boost { namespace threadpool
     typedef Task task_type; //!< Indicates the scheduler's task type.
 
   protected:
-    std::priority_queue<task_type> m_container;  //!< Internal task container.
+    detail::priority_task_queue<task_type> m_container;  //!< Internal task container.
 
 
   public:
@@ -210,6 +319,31 @@ namespace boost { namespace threadpool
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler. The task is moved into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      m_container.push(boost::move(task));
+      return true;
+    }
+#endif
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a new task in place in the scheduler.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      m_container.emplace(std::forward<Args>(args)...);
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -217,6 +351,15 @@ namespace boost { namespace threadpool
       m_container.pop();
     }
 
+    /*! Removes the task which should be executed next and moves it into the given object.
+    * \param task Receives the task object.
+    * \remarks The scheduler must not be empty.
+    */
+    void pop(task_type & task)
+    {
+      m_container.pop(task);
+    }
+
     /*! Gets the task which should be executed next.
     *  \return The task object to be executed.
     */
@@ -255,6 +398,670 @@ namespace boost { namespace threadpool
   };
 
 
+
+  /*! \brief SchedulingPolicy which implements bounded lock-free FIFO ordering. 
+  *
+  * This container implements a FIFO scheduling policy on top of a fixed-size 
+  * lock-free ring buffer. Producers and workers access it concurrently without
+  * any mutex. Tasks are rejected when the buffer is full, i.e. the pool's schedule
+  * function returns false.
+  *
+  * The scheduler is thread-safe and the pool accesses it without locking.
+  * The task type must be DefaultConstructible. A different capacity can be 
+  * chosen by deriving a scheduler which passes it to the constructor.
+  *
+  * \param Task A function object which implements the operator()(void).
+  *
+  */ 
+  template <typename Task = task_func>  
+  class bounded_fifo_scheduler
+  : private noncopyable
+  {
+  public:
+    typedef Task task_type;                 //!< Indicates the scheduler's task type.
+    typedef void concurrent_scheduler_tag;  //!< Indicates that the scheduler is thread-safe.
+
+    static size_t const default_capacity = 8192;  //!< Indicates the default maximum number of pending tasks.
+
+  protected:
+    detail::mpmc_ring_buffer<task_type> m_container;  //!< Internal task container.	
+
+  public:
+    /*! Constructor.
+    * \param capacity The maximum number of pending tasks, must be a power of two.
+    */
+    explicit bounded_fifo_scheduler(size_t const capacity = default_capacity)
+      : m_container(capacity)
+    {
+    }
+
+    /*! Adds a new task to the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false if the scheduler is full. 
+    */
+    bool push(task_type const & task)
+    {
+      return m_container.push(task);
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler. The task is moved into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false if the scheduler is full. 
+    */
+    bool push(task_type && task)
+    {
+      return m_container.push(boost::move(task));
+    }
+#endif
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a new task in place in the scheduler.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false if the scheduler is full. 
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      return m_container.emplace(std::forward<Args>(args)...);
+    }
+#endif
+
+    /*! Removes the task which should be executed next.
+    * \param task Receives the task object.
+    * \return true, if a task was removed and false if the scheduler is empty.
+    */
+    bool try_pop(task_type & task)
+    {
+      return m_container.pop(task);
+    }
+
+    /*! Gets the current number of tasks in the scheduler.
+    *  \return The number of tasks. The result is only a snapshot.
+    */
+    size_t size() const
+    {
+      return m_container.size();
+    }
+
+    /*! Checks if the scheduler is empty.
+    *  \return true if the scheduler contains no tasks, false otherwise. The result is only a snapshot.
+    */
+    bool empty() const
+    {
+      return m_container.empty();
+    }
+
+    /*! Removes all tasks from the scheduler.
+    */  
+    void clear()
+    {    
+      m_container.clear();
+    } 
+  };
+
+
+
+  /*! \brief SchedulingPolicy which implements intrusive FIFO ordering. 
+  *
+  * This container links the scheduled objects into an intrusive lock-free queue
+  * based on Dmitry Vyukov's multi-producer single-consumer algorithm. Scheduling
+  * neither copies the object nor allocates memory and never blocks. Workers take
+  * turns at the consumer end, which is serialized by a mutex. The objects are 
+  * owned by the caller, see intrusive_task_hook. Empty tasks are rejected.
+  *
+  * The scheduler is thread-safe and the pool accesses it without locking.
+  *
+  * \param Task A task which refers to an intrusive_task_hook, i.e. intrusive_task.
+  *
+  */ 
+  template <typename Task = intrusive_task>  
+  class intrusive_fifo_scheduler
+  : private noncopyable
+  {
+  public:
+    typedef Task task_type;                 //!< Indicates the scheduler's task type.
+    typedef void concurrent_scheduler_tag;  //!< Indicates that the scheduler is thread-safe.
+
+  protected:
+    detail::intrusive_mpsc_queue  m_container;          //!< Internal task container.	
+    mutex                         m_consumer_monitor;   //!< Serializes the consumers of the container.
+
+  public:
+    /*! Adds a new task to the scheduler. The task's object is linked into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false if the task is empty. 
+    */
+    bool push(task_type const & task)
+    {
+      intrusive_task_hook* const hook = task.hook();
+      if(!hook)
+      {
+        return false;
+      }
+
+      m_container.push(*hook);
+      return true;
+    }
+
+    /*! Removes the task which should be executed next. The task's object is unlinked.
+    * \param task Receives the task object.
+    * \return true, if a task was removed and false if the scheduler is empty.
+    */
+    bool try_pop(task_type & task)
+    {
+      detail::intrusive_queue_node* node;
+      {
+        mutex::scoped_lock lock(m_consumer_monitor);
+        node = m_container.pop();
+      }
+
+      if(!node)
+      {
+        return false;
+      }
+
+      task = task_type(*static_cast<intrusive_task_hook*>(node));
+      return true;
+    }
+
+    /*! Gets the current number of tasks in the scheduler.
+    *  \return The number of tasks. The result is only a snapshot.
+    */
+    size_t size() const
+    {
+      return m_container.size();
+    }
+
+    /*! Checks if the scheduler is empty.
+    *  \return true if the scheduler contains no tasks, false otherwise. The result is only a snapshot.
+    */
+    bool empty() const
+    {
+      return m_container.empty();
+    }
+
+    /*! Removes all tasks from the scheduler. Their objects are unlinked but not executed.
+    */  
+    void clear()
+    {    
+      mutex::scoped_lock lock(m_consumer_monitor);
+      while(m_container.pop())
+      {
+      }
+    } 
+  };
+
+
+
+  /*! \brief SchedulingPolicy which implements work stealing. 
+  *
+  * Each worker thread owns a private deque. Tasks which are scheduled by a 
+  * worker are pushed to the bottom of its own deque and are processed in LIFO order
+  * by this worker, which keeps the working set of recursively spawned tasks
+  * cache-warm. Tasks which are scheduled by other threads are added to a shared 
+  * FIFO injection queue. A worker whose deque is empty takes tasks from the 
+  * injection queue and finally steals from the top of the deques of randomly 
+  * chosen victims before it goes to sleep.
+  *
+  * A worker's deque holds pointers to boxes which contain the tasks. The boxes
+  * are recycled: each worker keeps a free list of the boxes it allocated, and a
+  * thief returns the box of a stolen task to its owner's list without locking.
+  * The heap is only used while the number of tasks in flight grows.
+  *
+  * The scheduler is thread-safe and the pool accesses it without locking.
+  * The task type must be DefaultConstructible.
+  *
+  * \param Task A function object which implements the operator()(void).
+  *
+  */ 
+  template <typename Task = task_func>  
+  class work_stealing_scheduler
+  : private noncopyable
+  {
+  public:
+    typedef Task task_type;                 //!< Indicates the scheduler's task type.
+    typedef void concurrent_scheduler_tag;  //!< Indicates that the scheduler is thread-safe.
+
+  private:
+    struct worker_queue;
+
+    /// Storage of a task in a worker's deque.
+    struct task_box
+    {
+      typename aligned_storage<sizeof(task_type), alignment_of<task_type>::value>::type m_storage;
+      task_box*       m_next;   // Link of a free list.
+      worker_queue*   m_home;   // The queue whose free list the box belongs to.
+
+      task_type* task()
+      {
+        return static_cast<task_type*>(static_cast<void*>(&m_storage));
+      }
+    };
+
+    /// Deque of a worker thread.
+    struct worker_queue
+    {
+      detail::work_stealing_deque<task_box>   m_deque;
+      work_stealing_scheduler const * const   m_owner;          // The scheduler the deque belongs to.
+      atomic<bool>                            m_attached;       // Indicates if a worker thread uses the deque.
+      unsigned int                            m_seed;           // State of the victim selection, used by the attached worker only.
+      task_box*                               m_free_boxes;     // Used by the attached worker only.
+      atomic<task_box*>                       m_returned_boxes; // Boxes of stolen tasks, returned by other threads.
+
+      worker_queue(work_stealing_scheduler const * const owner, unsigned int const seed)
+        : m_owner(owner)
+        , m_attached(true)
+        , m_seed(seed | 1)
+        , m_free_boxes(0)
+        , m_returned_boxes(0)
+      {
+      }
+
+      ~worker_queue()
+      {
+        delete_boxes(m_free_boxes);
+        delete_boxes(m_returned_boxes.load(memory_order_acquire));
+      }
+
+      static void delete_boxes(task_box* box)
+      {
+        while(box)
+        {
+          task_box* const next = box->m_next;
+          delete box;
+          box = next;
+        }
+      }
+    };
+
+    typedef detail::thread_local_ptr<worker_queue, work_stealing_scheduler> current_queue_type;
+
+    static std::size_t const max_worker_queues = 256;  //!< Further workers use the injection queue only.
+
+    atomic<worker_queue*>           m_queues[max_worker_queues];
+    atomic<std::size_t>             m_queue_count;
+    mutex                           m_queue_monitor;      // Serializes the creation of worker deques.
+
+    std::deque<task_type>           m_injection_queue;    // Tasks scheduled by threads which are not workers.
+    atomic<std::size_t>             m_injection_size;
+    mutex                           m_injection_monitor;
+
+  public:
+    /// Constructor.
+    work_stealing_scheduler()
+      : m_queue_count(0)
+      , m_injection_size(0)
+    {
+    }
+
+    /// Destructor.
+    ~work_stealing_scheduler()
+    {
+      clear();
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        delete m_queues[i].load(memory_order_relaxed);
+      }
+    }
+
+    /*! Assigns a deque to the calling worker thread. The deque of a terminated worker is reused.
+    */
+    void attach_worker()
+    {
+      worker_queue* queue = 0;
+
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      for(std::size_t i = 0; i < count && !queue; ++i)
+      {
+        worker_queue* const candidate = m_queues[i].load(memory_order_relaxed);
+        if(!candidate->m_attached.load(memory_order_relaxed)
+          && !candidate->m_attached.exchange(true, memory_order_acquire))
+        {
+          queue = candidate;
+        }
+      }
+
+      if(!queue)
+      {
+        mutex::scoped_lock lock(m_queue_monitor);
+        std::size_t const index = m_queue_count.load(memory_order_relaxed);
+        if(index < max_worker_queues)
+        {
+          queue = new worker_queue(this, static_cast<unsigned int>(index + 1) * 2654435761u);
+          m_queues[index].store(queue, memory_order_release);
+          m_queue_count.store(index + 1, memory_order_release);
+        }
+      }
+
+      current_queue_type::reset(queue);
+    }
+
+    /*! Releases the deque of the calling worker thread. Remaining tasks can still be stolen.
+    */
+    void detach_worker()
+    {
+      worker_queue* const queue = current_queue();
+      if(queue)
+      {
+        current_queue_type::reset(0);
+        queue->m_attached.store(false, memory_order_release);
+      }
+    }
+
+    /*! Adds a new task to the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type const & task)
+    {
+      worker_queue* const queue = current_queue();
+      if(queue)
+      {
+        task_box* const box = acquire_box(*queue);
+        try
+        {
+          new(box->task()) task_type(task);
+        }
+        catch(...)
+        {
+          release_box(box, queue);
+          throw;
+        }
+        push_box(*queue, box);
+      }
+      else
+      {
+        mutex::scoped_lock lock(m_injection_monitor);
+        m_injection_queue.push_back(task);
+        m_injection_size.fetch_add(1, memory_order_release);
+      }
+      return true;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler. The task is moved into the scheduler.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      worker_queue* const queue = current_queue();
+      if(queue)
+      {
+        task_box* const box = acquire_box(*queue);
+        try
+        {
+          new(box->task()) task_type(boost::move(task));
+        }
+        catch(...)
+        {
+          release_box(box, queue);
+          throw;
+        }
+        push_box(*queue, box);
+      }
+      else
+      {
+        mutex::scoped_lock lock(m_injection_monitor);
+        m_injection_queue.push_back(boost::move(task));
+        m_injection_size.fetch_add(1, memory_order_release);
+      }
+      return true;
+    }
+#endif
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    /*! Constructs a new task in place in the scheduler.
+    * \param args The arguments of the task's constructor.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+      worker_queue* const queue = current_queue();
+      if(queue)
+      {
+        task_box* const box = acquire_box(*queue);
+        try
+        {
+          new(box->task()) task_type(std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+          release_box(box, queue);
+          throw;
+        }
+        push_box(*queue, box);
+      }
+      else
+      {
+        mutex::scoped_lock lock(m_injection_monitor);
+        m_injection_queue.emplace_back(std::forward<Args>(args)...);
+        m_injection_size.fetch_add(1, memory_order_release);
+      }
+      return true;
+    }
+#endif
+
+    /*! Removes the task which should be executed next by the calling thread.
+    * \param task Receives the task object.
+    * \return true, if a task was removed and false if no task was found.
+    */
+    bool try_pop(task_type & task)
+    {
+      worker_queue* const queue = current_queue();
+
+      task_box* box = queue ? queue->m_deque.pop() : 0;
+      if(!box)
+      {
+        if(pop_injected(task))
+        {
+          return true;
+        }
+        box = steal(queue);
+      }
+
+      if(box)
+      {
+        try
+        {
+          task = boost::move(*box->task());
+        }
+        catch(...)
+        {
+          discard_box(box, queue);
+          throw;
+        }
+        discard_box(box, queue);
+        return true;
+      }
+      return false;
+    }
+
+    /*! Gets the current number of tasks in the scheduler.
+    *  \return The number of tasks. The result is only a snapshot.
+    */
+    size_t size() const
+    {
+      size_t result = m_injection_size.load(memory_order_relaxed);
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        result += m_queues[i].load(memory_order_relaxed)->m_deque.size();
+      }
+      return result;
+    }
+
+    /*! Checks if the scheduler is empty.
+    *  \return true if the scheduler contains no tasks, false otherwise. The result is only a snapshot.
+    *  \remarks Is more efficient than size() == 0. 
+    */
+    bool empty() const
+    {
+      if(m_injection_size.load(memory_order_relaxed) > 0)
+      {
+        return false;
+      }
+
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        if(!m_queues[i].load(memory_order_relaxed)->m_deque.empty())
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /*! Removes all tasks from the scheduler.
+    */  
+    void clear()
+    {
+      {
+        mutex::scoped_lock lock(m_injection_monitor);
+        m_injection_queue.clear();
+        m_injection_size.store(0, memory_order_release);
+      }
+
+      worker_queue* const current = current_queue();
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        detail::work_stealing_deque<task_box> & deque = m_queues[i].load(memory_order_relaxed)->m_deque;
+        while(!deque.empty())
+        {
+          task_box* const box = deque.steal();
+          if(box)
+          {
+            discard_box(box, current);
+          }
+        }
+      }
+    }
+
+  private:
+    worker_queue* current_queue() const
+    {
+      worker_queue* const queue = current_queue_type::get();
+      return queue && queue->m_owner == this ? queue : 0;
+    }
+
+    // Takes an empty box from the free lists of the calling worker's queue or allocates one.
+    static task_box* acquire_box(worker_queue & queue)
+    {
+      task_box* box = queue.m_free_boxes;
+      if(!box)
+      {
+        box = queue.m_returned_boxes.exchange(0, memory_order_acquire);
+        if(!box)
+        {
+          box = new task_box;
+          box->m_home = &queue;
+          return box;
+        }
+      }
+      queue.m_free_boxes = box->m_next;
+      return box;
+    }
+
+    // Returns an empty box to its queue. Other threads push it to the returned boxes, 
+    // which the owner takes as a whole, so the list is not subject to the ABA problem.
+    static void release_box(task_box* const box, worker_queue* const current)
+    {
+      worker_queue* const home = box->m_home;
+      if(home == current)
+      {
+        box->m_next = home->m_free_boxes;
+        home->m_free_boxes = box;
+        return;
+      }
+
+      task_box* head = home->m_returned_boxes.load(memory_order_relaxed);
+      do
+      {
+        box->m_next = head;
+      }
+      while(!home->m_returned_boxes.compare_exchange_weak(head, box, memory_order_release, memory_order_relaxed));
+    }
+
+    // Destructs the box's task and releases the box.
+    static void discard_box(task_box* const box, worker_queue* const current)
+    {
+      box->task()->~task_type();
+      release_box(box, current);
+    }
+
+    // Pushes a box with a task to the calling worker's deque. The box is discarded if the deque cannot grow.
+    static void push_box(worker_queue & queue, task_box* const box)
+    {
+      try
+      {
+        queue.m_deque.push(box);
+      }
+      catch(...)
+      {
+        discard_box(box, &queue);
+        throw;
+      }
+    }
+
+    bool pop_injected(task_type & task)
+    {
+      if(m_injection_size.load(memory_order_acquire) == 0)
+      {
+        return false;
+      }
+
+      mutex::scoped_lock lock(m_injection_monitor);
+      if(m_injection_queue.empty())
+      {
+        return false;
+      }
+
+      task = boost::move(m_injection_queue.front());
+      m_injection_queue.pop_front();
+      m_injection_size.fetch_sub(1, memory_order_relaxed);
+      return true;
+    }
+
+    task_box* steal(worker_queue* const thief)
+    {
+      std::size_t const count = m_queue_count.load(memory_order_acquire);
+      if(count == 0)
+      {
+        return 0;
+      }
+
+      std::size_t start = 0;
+      if(thief)
+      { // xorshift victim selection
+        thief->m_seed ^= thief->m_seed << 13;
+        thief->m_seed ^= thief->m_seed >> 17;
+        thief->m_seed ^= thief->m_seed << 5;
+        start = thief->m_seed % count;
+      }
+
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        worker_queue* const victim = m_queues[(start + i) % count].load(memory_order_relaxed);
+        if(victim != thief)
+        {
+          task_box* const box = victim->m_deque.steal();
+          if(box)
+          {
+            return box;
+          }
+        }
+      }
+      return 0;
+    }
+  };
+
+
+
 } } // namespace boost::threadpool
 
 
@@ -22,6 +22,14 @@
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
 
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#endif
+
 
 namespace boost { namespace threadpool
 {
@@ -58,6 +66,13 @@ namespace boost { namespace threadpool
     typedef void result_type; //!< Indicates the functor's result type.
 
   public:
+    /*! Constructs an empty task with the lowest priority.
+    */
+    prio_task_func()
+      : m_priority(0)
+    {
+    }
+
     /*! Constructor.
     * \param priority The priority of the task.
     * \param function The task's function object.
@@ -162,6 +177,111 @@ namespace boost { namespace threadpool
   }; // looped_task_func
 
 
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  namespace detail
+  {
+    /// Sequence of indices of a function call's arguments.
+    template <std::size_t... Indices>
+    struct index_list
+    {
+    };
+
+    template <std::size_t Count, std::size_t... Indices>
+    struct make_index_list
+    : make_index_list<Count - 1, Count - 1, Indices...>
+    {
+    };
+
+    template <std::size_t... Indices>
+    struct make_index_list<0, Indices...>
+    {
+      typedef index_list<Indices...> type;
+    };
+
+
+    /// Makes a member function pointer callable with the object as first argument.
+    template <typename Function>
+    typename std::enable_if<std::is_member_pointer<Function>::value, decltype(std::mem_fn(std::declval<Function>()))>::type
+    make_callable(Function function)
+    {
+      return std::mem_fn(function);
+    }
+
+    template <typename Function>
+    typename std::enable_if<!std::is_member_pointer<Function>::value, Function>::type
+    make_callable(Function function)
+    {
+      return function;
+    }
+
+  } // namespace detail
+
+
+  /*! \brief Deferred function call.
+  *
+  * This function object stores a function and copies of its arguments and calls
+  * the function with these arguments when it is invoked. It is the task created by
+  * thread_pool::schedule(function, args...) and replaces a bind expression wrapped
+  * in a task_func: the call is stored in the task without further allocations. The
+  * arguments are moved into the call, so it must be invoked only once.
+  *
+  * \param Function The type of the function object.
+  * \param Args The types of the stored arguments.
+  */
+  template <typename Function, typename... Args>
+  class deferred_call
+  {
+  private:
+    Function              m_function;   //!< The function.
+    std::tuple<Args...>   m_arguments;  //!< The arguments.
+
+  public:
+    typedef void result_type; //!< Indicates the functor's result type.
+
+  public:
+    /*! Constructor.
+    * \param function The function.
+    * \param args The arguments.
+    */
+    explicit deferred_call(Function function, Args... args)
+      : m_function(std::move(function))
+      , m_arguments(std::move(args)...)
+    {
+    }
+
+    /*! Calls the function. Its result is discarded.
+    */
+    void operator() (void)
+    {
+      invoke(typename detail::make_index_list<sizeof...(Args)>::type());
+    }
+
+  private:
+    template <std::size_t... Indices>
+    void invoke(detail::index_list<Indices...>)
+    {
+      m_function(std::move(std::get<Indices>(m_arguments))...);
+    }
+  };
+
+
+  /*! Creates a deferred function call.
+  * \param function The function object, function pointer or member function pointer.
+  * \param args The arguments, for a member function the object or a pointer to it first. They are copied or moved into the call.
+  * \return The deferred call.
+  */
+  template <typename Function, typename... Args>
+  deferred_call<decltype(detail::make_callable(std::declval<typename std::decay<Function>::type>())), typename std::decay<Args>::type...>
+  make_deferred_call(Function && function, Args &&... args)
+  {
+    typedef decltype(detail::make_callable(std::declval<typename std::decay<Function>::type>())) function_type;
+    return deferred_call<function_type, typename std::decay<Args>::type...>(
+      detail::make_callable(typename std::decay<Function>::type(std::forward<Function>(function))), std::forward<Args>(args)...);
+  }
+#endif
+
+
 } } // namespace boost::threadpool
 
 #endif // THREADPOOL_TASK_ADAPTERS_HPP_INCLUDED
@@ -0,0 +1,453 @@
+/*! \file
+* \brief Task dependency graph.
+*
+* This file contains the task_graph class, which executes tasks with
+* explicit dependencies on a pool. A task is released as soon as all of
+* its predecessors are finished, without any barrier between the levels
+* of the graph. The captured_task_graph class replays a graph of fixed
+* shape without allocating memory.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_TASK_GRAPH_HPP_INCLUDED
+#define THREADPOOL_TASK_GRAPH_HPP_INCLUDED
+
+
+#include "task_adaptors.hpp"
+#include "task_group.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /// Creates a pool task for a graph node. The priority is ignored unless the task type supports it.
+    template <typename Task, typename Function>
+    Task make_graph_task(Task*, Function const & function, unsigned int)
+    {
+      return Task(function);
+    }
+
+    /// Creates a prioritized pool task for a graph node, so that a prio_scheduler orders the ready nodes.
+    template <typename Function>
+    prio_task_func make_graph_task(prio_task_func*, Function const & function, unsigned int const priority)
+    {
+      return prio_task_func(priority, function);
+    }
+
+  } // namespace detail
+
+
+  template <typename Pool> class captured_task_graph;
+
+
+  /*! \brief Directed acyclic graph of tasks.
+  *
+  * Each node holds a task function and the number of its predecessors. When the
+  * graph runs, each node has an atomic counter of unfinished predecessors. The
+  * worker which finishes the last predecessor releases the node: it continues with
+  * one released node itself and schedules the others directly on the pool.
+  *
+  * Optionally the ready nodes are ordered by their critical path length, the
+  * largest cost of any path from the node to the end of the graph. Preferring long
+  * paths shortens the makespan. Pools with prio_task_func tasks and a prio_scheduler
+  * order all ready nodes by their critical path, other pools order the nodes released
+  * at the same time.
+  *
+  * The graph can be run any number of times but must not be modified while it runs.
+  * Each run prepares the execution anew; a captured_task_graph prepares it once.
+  *
+  * \see task_func, prio_pool, captured_task_graph
+  */
+  class task_graph
+  : private noncopyable
+  {
+  public:
+    typedef std::size_t node_id;   //!< Indicates the type of a node's handle.
+
+    /// Determines the order in which ready nodes are executed.
+    enum ready_order
+    {
+      release_order,          //!< The nodes are scheduled in the order they become ready.
+      critical_path_first     //!< Nodes with a longer critical path are preferred.
+    };
+
+  private:
+    template <typename Pool> friend class captured_task_graph;
+
+    struct node
+    {
+      task_func               task;
+      unsigned int            cost;
+      std::size_t             predecessors;
+      std::vector<node_id>    successors;
+    };
+
+    std::vector<node> m_nodes;
+
+  public:
+    /*! Adds a node.
+    * \param task The node's task function. It should not throw exceptions.
+    * \param cost The estimated duration of the task in arbitrary units, used for critical path ordering.
+    * \return The node's handle.
+    */
+    node_id add_node(task_func const & task, unsigned int const cost = 1)
+    {
+      node new_node;
+      new_node.task = task;
+      new_node.cost = cost;
+      new_node.predecessors = 0;
+      m_nodes.push_back(new_node);
+      return m_nodes.size() - 1;
+    }
+
+
+    /*! Adds a dependency. The successor is not started before the predecessor is finished.
+    * \param predecessor The node which must be finished first.
+    * \param successor The dependent node.
+    */
+    void add_edge(node_id const predecessor, node_id const successor)
+    {
+      assert(predecessor < m_nodes.size() && successor < m_nodes.size());
+      m_nodes[predecessor].successors.push_back(successor);
+      ++m_nodes[successor].predecessors;
+    }
+
+
+    /*! Gets the number of nodes.
+    * \return The number of nodes.
+    */
+    std::size_t size() const
+    {
+      return m_nodes.size();
+    }
+
+
+    /*! Removes all nodes.
+    */
+    void clear()
+    {
+      m_nodes.clear();
+    }
+
+
+    /*! Executes all tasks of the graph in dependency order. The calling thread participates.
+    * \param pool The pool which executes the tasks.
+    * \param order Determines the order in which ready nodes are executed.
+    * \return true, if all tasks were executed and false if the graph contains a cycle. Then no task is executed.
+    */
+    template <typename Pool>
+    bool run(Pool const & pool, ready_order const order = release_order) const;
+
+
+  private:
+    // Gets the nodes in topological order. Returns false if the graph contains a cycle.
+    bool sort_topologically(std::vector<node_id> & sorted) const
+    {
+      std::vector<std::size_t> predecessors(m_nodes.size());
+      sorted.clear();
+      sorted.reserve(m_nodes.size());
+      for(node_id id = 0; id < m_nodes.size(); ++id)
+      {
+        predecessors[id] = m_nodes[id].predecessors;
+        if(predecessors[id] == 0)
+        {
+          sorted.push_back(id);
+        }
+      }
+
+      for(std::size_t i = 0; i < sorted.size(); ++i)
+      {
+        std::vector<node_id> const & successors = m_nodes[sorted[i]].successors;
+        for(std::vector<node_id>::const_iterator it = successors.begin(); it != successors.end(); ++it)
+        {
+          if(--predecessors[*it] == 0)
+          {
+            sorted.push_back(*it);
+          }
+        }
+      }
+
+      return sorted.size() == m_nodes.size();
+    }
+
+
+    // Computes the critical path length of each node from a topological order.
+    void compute_critical_paths(std::vector<node_id> const & sorted, std::vector<unsigned int> & lengths) const
+    {
+      lengths.assign(m_nodes.size(), 0);
+      for(std::vector<node_id>::const_reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it)
+      {
+        node const & current = m_nodes[*it];
+        unsigned int longest = 0;
+        for(std::vector<node_id>::const_iterator succ = current.successors.begin(); succ != current.successors.end(); ++succ)
+        {
+          longest = (std::max)(longest, lengths[*succ]);
+        }
+        lengths[*it] = longest < UINT_MAX - current.cost ? longest + current.cost : UINT_MAX;
+      }
+    }
+  };
+
+
+  /*! \brief Task graph which is prepared once and executed repeatedly.
+  *
+  * Capturing a task_graph copies its tasks and edges into flat arrays and computes
+  * the order of the successors and the priority of each node. Running the
+  * captured graph only resets the predecessor counters and releases the roots, it
+  * does not allocate memory. The captured graph is independent of the task_graph.
+  *
+  * A captured graph must not be run concurrently with itself.
+  *
+  * \param Pool The pool type which executes the tasks.
+  *
+  * \see task_graph
+  */
+  template <typename Pool = pool>
+  class captured_task_graph
+  : private noncopyable
+  {
+  public:
+    typedef task_graph::node_id node_id;              //!< Indicates the type of a node's handle.
+    typedef typename Pool::task_type task_type;       //!< Indicates the pool's task type.
+
+  private:
+    /// Pool task which executes a node.
+    class node_task
+    {
+      captured_task_graph* m_graph;
+      node_id              m_node;
+
+    public:
+      typedef void result_type;
+
+      node_task(captured_task_graph & graph, node_id const node)
+        : m_graph(&graph)
+        , m_node(node)
+      {
+      }
+
+      void operator()() const
+      {
+        // the graph may be destroyed as soon as the last task is finished
+        shared_ptr<detail::task_group_state> const tasks(m_graph->m_tasks);
+        m_graph->execute(m_node);
+        tasks->task_finished();
+      }
+    };
+
+    /// Orders nodes by descending critical path length.
+    class longer_critical_path
+    {
+      std::vector<unsigned int> const & m_lengths;
+
+    public:
+      explicit longer_critical_path(std::vector<unsigned int> const & lengths)
+        : m_lengths(lengths)
+      {
+      }
+
+      bool operator()(node_id const lhs, node_id const rhs) const
+      {
+        return m_lengths[lhs] > m_lengths[rhs];
+      }
+    };
+
+    Pool                                      m_pool;
+    std::vector<task_func>                    m_functions;
+    std::vector<unsigned int>                 m_priorities;               // The critical path lengths.
+    std::vector<std::size_t>                  m_predecessors;
+    std::vector<std::size_t>                  m_first_successor;          // The successors of node i are [m_first_successor[i], m_first_successor[i + 1]).
+    std::vector<node_id>                      m_successors;               // Ordered by urgency.
+    std::vector<node_id>                      m_roots;                    // Ordered by urgency.
+    scoped_array<atomic<std::size_t> >        m_unfinished_predecessors;
+    shared_ptr<detail::task_group_state>      m_tasks;                    // Counts the scheduled tasks.
+
+  public:
+    /*! Constructor. The graph is empty until a task graph is captured.
+    * \param pool The pool which executes the tasks.
+    */
+    explicit captured_task_graph(Pool const & pool)
+      : m_pool(pool)
+      , m_first_successor(1, 0)
+      , m_tasks(new detail::task_group_state)
+    {
+    }
+
+
+    /*! Prepares the execution of a task graph and replaces the previously captured graph.
+    * \param graph The task graph. It may be modified or destroyed afterwards.
+    * \param order Determines the order in which ready nodes are executed.
+    * \return true, if the graph was captured and false if it contains a cycle. Then the captured graph is empty.
+    */
+    bool capture(task_graph const & graph, task_graph::ready_order const order = task_graph::release_order)
+    {
+      std::vector<task_graph::node> const & nodes = graph.m_nodes;
+      std::size_t const size = nodes.size();
+
+      m_functions.clear();
+      m_priorities.clear();
+      m_predecessors.clear();
+      m_first_successor.assign(1, 0);
+      m_successors.clear();
+      m_roots.clear();
+      m_unfinished_predecessors.reset();
+
+      std::vector<node_id> sorted;
+      if(!graph.sort_topologically(sorted))
+      {
+        return false;
+      }
+
+      std::vector<unsigned int> critical_paths;
+      graph.compute_critical_paths(sorted, critical_paths);
+
+      m_functions.reserve(size);
+      m_predecessors.reserve(size);
+      m_first_successor.reserve(size + 1);
+      for(node_id id = 0; id < size; ++id)
+      {
+        m_functions.push_back(nodes[id].task);
+        m_predecessors.push_back(nodes[id].predecessors);
+        m_successors.insert(m_successors.end(), nodes[id].successors.begin(), nodes[id].successors.end());
+        m_first_successor.push_back(m_successors.size());
+        if(nodes[id].predecessors == 0)
+        {
+          m_roots.push_back(id);
+        }
+      }
+
+      if(order == task_graph::critical_path_first)
+      {
+        longer_critical_path const urgency(critical_paths);
+        for(node_id id = 0; id < size; ++id)
+        {
+          std::stable_sort(m_successors.begin() + m_first_successor[id], m_successors.begin() + m_first_successor[id + 1], urgency);
+        }
+        std::stable_sort(m_roots.begin(), m_roots.end(), urgency);
+      }
+
+      m_priorities.swap(critical_paths);
+      m_unfinished_predecessors.reset(new atomic<std::size_t>[size]);
+      return true;
+    }
+
+
+    /*! Gets the number of nodes.
+    * \return The number of nodes.
+    */
+    std::size_t size() const
+    {
+      return m_functions.size();
+    }
+
+
+    /*! Executes all tasks of the captured graph in dependency order. The calling thread participates.
+    */
+    void run()
+    {
+      for(node_id id = 0; id < m_predecessors.size(); ++id)
+      {
+        m_unfinished_predecessors[id].store(m_predecessors[id], memory_order_relaxed);
+      }
+
+      if(!m_roots.empty())
+      {
+        for(std::vector<node_id>::const_iterator it = m_roots.begin() + 1; it != m_roots.end(); ++it)
+        {
+          schedule(*it);
+        }
+        execute(m_roots.front());
+      }
+      m_tasks->wait(0);
+    }
+
+
+  private:
+    // Executes a node and then the most urgent node it releases, until a node releases none.
+    void execute(node_id node)
+    {
+      for(;;)
+      {
+        if(m_functions[node])
+        {
+          m_functions[node]();
+        }
+
+        bool released = false;
+        node_id next = 0;
+        for(std::size_t i = m_first_successor[node]; i != m_first_successor[node + 1]; ++i)
+        {
+          node_id const successor = m_successors[i];
+          if(m_unfinished_predecessors[successor].fetch_sub(1, memory_order_acq_rel) == 1)
+          {
+            if(released)
+            {
+              schedule(successor);
+            }
+            else
+            {
+              released = true;
+              next = successor;
+            }
+          }
+        }
+
+        if(!released)
+        {
+          return;
+        }
+        node = next;
+      }
+    }
+
+
+    void schedule(node_id const node)
+    {
+      m_tasks->task_added();
+      if(!m_pool.schedule(detail::make_graph_task(static_cast<task_type*>(0), node_task(*this, node), m_priorities[node])))
+      { // the pool is full or terminated, the node must not be lost
+        node_task(*this, node)();
+      }
+    }
+  };
+
+
+  template <typename Pool>
+  bool task_graph::run(Pool const & pool, ready_order const order) const
+  {
+    captured_task_graph<Pool> captured(pool);
+    if(!captured.capture(*this, order))
+    {
+      return false;
+    }
+
+    captured.run();
+    return true;
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_TASK_GRAPH_HPP_INCLUDED
@@ -0,0 +1,256 @@
+/*! \file
+* \brief Task group.
+*
+* This file contains the task_group class which joins a set of related
+* tasks without waiting for the other tasks of the pool.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_TASK_GROUP_HPP_INCLUDED
+#define THREADPOOL_TASK_GROUP_HPP_INCLUDED
+
+
+#include "./detail/worker_context.hpp"
+#include "pool.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/xtime.hpp>
+#include <boost/utility.hpp>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /*! \brief Shared state of a task group.
+    *
+    * The state outlives the group as long as one of its tasks exists.
+    */
+    class task_group_state
+    : private noncopyable
+    {
+      atomic<size_t>      m_unfinished_tasks;
+      atomic<bool>        m_cancelled;
+
+      mutable mutex       m_monitor;
+      mutable condition   m_finished;
+
+    public:
+      task_group_state()
+        : m_unfinished_tasks(0)
+        , m_cancelled(false)
+      {
+      }
+
+      void task_added()
+      {
+        m_unfinished_tasks.fetch_add(1, memory_order_relaxed);
+      }
+
+      // Called once for each task, either when it was executed or when it was discarded by the pool.
+      void task_finished()
+      {
+        if(m_unfinished_tasks.fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+          mutex::scoped_lock lock(m_monitor);
+          m_finished.notify_all();
+        }
+      }
+
+      bool finished() const
+      {
+        return m_unfinished_tasks.load(memory_order_acquire) == 0;
+      }
+
+      void cancel()
+      {
+        m_cancelled.store(true, memory_order_relaxed);
+      }
+
+      bool is_cancelled() const
+      {
+        return m_cancelled.load(memory_order_relaxed);
+      }
+
+      bool wait(xtime const * const timestamp)
+      {
+        worker_context* const worker = worker_context::current();
+        mutex::scoped_lock lock(m_monitor);
+        while(!finished())
+        {
+          if(worker)
+          { // execute pending tasks instead of blocking the worker
+            lock.unlock();
+            bool const executed = worker->execute_pending_task();
+            lock.lock();
+            if(executed || finished())
+            {
+              continue;
+            }
+
+            xtime const until = next_help_time(timestamp);
+            if(!m_finished.timed_wait(lock, until) && timestamp && xtime_cmp(until, *timestamp) >= 0)
+            {
+              return finished();
+            }
+          }
+          else if(timestamp)
+          {
+            if(!m_finished.timed_wait(lock, *timestamp))
+            {
+              return finished();
+            }
+          }
+          else
+          {
+            m_finished.wait(lock);
+          }
+        }
+
+        m_cancelled.store(false, memory_order_relaxed);
+        return true;
+      }
+    };
+
+
+    /*! \brief Task of a task group.
+    *
+    * The group is notified when the task was executed or when the last
+    * copy of the task is destroyed without being executed.
+    */
+    template <typename Function>
+    class task_group_func
+    {
+      mutable Function              m_function;
+      shared_ptr<task_group_state>  m_state;
+      mutable shared_ptr<void>      m_completion; // Calls task_finished() when the last copy is released.
+
+    public:
+      typedef void result_type;
+
+      task_group_func(Function const & function, shared_ptr<task_group_state> const & state)
+        : m_function(function)
+        , m_state(state)
+        , m_completion(state.get(), bind(&task_group_state::task_finished, state))
+      {
+      }
+
+      void operator()() const
+      {
+        if(m_completion)
+        {
+          if(!m_state->is_cancelled())
+          {
+            m_function();
+          }
+          m_completion.reset();
+        }
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! \brief Set of tasks which can be joined and cancelled together.
+  *
+  * The tasks of a group are executed by its pool like any other task, but
+  * wait() only waits for the tasks of the group. Independent groups sharing
+  * a pool therefore do not wait for each other. The group counts its
+  * unfinished tasks with an atomic counter and notifies its own waiters
+  * only when the count drops to zero.
+  *
+  * A task group is neither copyable nor thread-safe with respect to wait():
+  * run() may be called by any thread, including the group's tasks,
+  * but wait() should be called by one thread at a time.
+  *
+  * \param Pool The pool type. Its task type must be constructible from a nullary function object.
+  *
+  * \remarks A pool worker which calls wait() executes pending tasks of its pool in the meantime.
+  */
+  template <typename Pool = pool>
+  class task_group
+  : private noncopyable
+  {
+    Pool                                  m_pool;
+    shared_ptr<detail::task_group_state>  m_state;
+
+  public:
+    typedef Pool pool_type;   //!< Indicates the pool's type.
+
+    /*! Constructor.
+    * \param pool The pool which executes the tasks.
+    */
+    explicit task_group(pool_type const & pool)
+      : m_pool(pool)
+      , m_state(new detail::task_group_state)
+    {
+    }
+
+
+    /*! Schedules a task of the group.
+    * \param function The task function object. It should not throw exceptions.
+    * \return true, if the task could be scheduled and false otherwise.
+    */
+    template <typename Function>
+    bool run(Function const & function)
+    {
+      m_state->task_added();
+      return m_pool.schedule(detail::task_group_func<Function>(function, m_state));
+    }
+
+
+    /*! Blocks until all tasks of the group are finished. Cancelled tasks count as finished.
+    *  A cancelled group accepts tasks again afterwards.
+    */
+    void wait() const
+    {
+      m_state->wait(0);
+    }
+
+
+    /*! Blocks until all tasks of the group are finished or the timestamp is met.
+    * \param timestamp The time when function returns at the latest.
+    * \return true, if all tasks are finished and false otherwise.
+    */
+    bool wait(xtime const & timestamp) const
+    {
+      return m_state->wait(&timestamp);
+    }
+
+
+    /*! Cancels the group. Tasks of the group which have not been started are discarded,
+    *  active tasks are completed. The group stays cancelled until wait() returns.
+    */
+    void cancel()
+    {
+      m_state->cancel();
+    }
+
+
+    /*! Indicates whether the group was cancelled.
+    * \return true, if cancel() was called since the last wait().
+    */
+    bool is_cancelled() const
+    {
+      return m_state->is_cancelled();
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_TASK_GROUP_HPP_INCLUDED
@@ -0,0 +1,323 @@
+/*! \file
+* \brief Move-only task function object.
+*
+* This file contains basic_unique_task, a task function object which stores
+* small function objects inline and accepts function objects which cannot be
+* copied. It requires a compiler which supports rvalue references.
+*
+* Copyright (c) 2005-2007 Philipp Henkel
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_UNIQUE_TASK_HPP_INCLUDED
+#define THREADPOOL_UNIQUE_TASK_HPP_INCLUDED
+
+
+#include <boost/config.hpp>
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#include <boost/function.hpp>
+#include <boost/static_assert.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace boost { namespace threadpool
+{
+
+  namespace detail
+  {
+    /// Checks if a function object is known to be empty. Such tasks are not stored.
+    template <typename Function>
+    inline bool is_null_function(Function const &)
+    {
+      return false;
+    }
+
+    template <typename Function>
+    inline bool is_null_function(Function * const pointer)
+    {
+      return pointer == 0;
+    }
+
+    template <typename Signature>
+    inline bool is_null_function(function<Signature> const & wrapper)
+    {
+      return wrapper.empty();
+    }
+
+    template <typename Result>
+    inline bool is_null_function(function0<Result> const & wrapper)
+    {
+      return wrapper.empty();
+    }
+
+
+    /// Checks if a function object can be called without arguments.
+    template <typename Function, typename Enable = void>
+    struct is_nullary_callable
+    : std::false_type
+    {
+    };
+
+    template <typename Function>
+    struct is_nullary_callable<Function, decltype(void(std::declval<Function&>()()))>
+    : std::true_type
+    {
+    };
+
+  } // namespace detail
+
+
+  /*! \brief Move-only task function object with inline storage.
+  *
+  * The task wraps a nullary function object. Function objects which fit into
+  * InlineCapacity bytes and can be moved without throwing are stored inside
+  * the task, larger ones are allocated on the heap. In contrast to task_func
+  * the function object needs not be copyable, it only has to be MoveConstructible.
+  * Moving a task never throws.
+  *
+  * \param InlineCapacity The number of bytes available for inline storage.
+  *
+  * \see unique_task, task_func
+  */
+  template <std::size_t InlineCapacity>
+  class basic_unique_task
+  {
+    BOOST_STATIC_ASSERT(InlineCapacity >= sizeof(void*));
+
+    /// Type-specific operations on the stored function object.
+    struct operations
+    {
+      void (*invoke)(void* storage);
+      void (*relocate)(void* target, void* source);   // Moves the function object to the target storage and destroys the source.
+      void (*destroy)(void* storage);
+    };
+
+    /// Operations on a function object stored inline.
+    template <typename Function>
+    struct inline_operations
+    {
+      static void invoke(void* storage)
+      {
+        (*static_cast<Function*>(storage))();
+      }
+
+      static void relocate(void* target, void* source)
+      {
+        Function* const function = static_cast<Function*>(source);
+        ::new(target) Function(std::move(*function));
+        function->~Function();
+      }
+
+      static void destroy(void* storage)
+      {
+        static_cast<Function*>(storage)->~Function();
+      }
+
+      static operations const * table()
+      {
+        static operations const instance = { &invoke, &relocate, &destroy };
+        return &instance;
+      }
+    };
+
+    /// Operations on a function object stored on the heap. The storage holds the pointer.
+    template <typename Function>
+    struct heap_operations
+    {
+      static void invoke(void* storage)
+      {
+        (**static_cast<Function**>(storage))();
+      }
+
+      static void relocate(void* target, void* source)
+      {
+        *static_cast<Function**>(target) = *static_cast<Function**>(source);
+      }
+
+      static void destroy(void* storage)
+      {
+        delete *static_cast<Function**>(storage);
+      }
+
+      static operations const * table()
+      {
+        static operations const instance = { &invoke, &relocate, &destroy };
+        return &instance;
+      }
+    };
+
+    typedef typename std::aligned_storage<InlineCapacity, alignof(std::max_align_t)>::type storage_type;
+
+    storage_type          m_storage;
+    operations const *    m_operations;   //!< Null if the task is empty.
+
+  public:
+    typedef void result_type;                                           //!< Indicates the functor's result type.
+    static std::size_t const inline_capacity = InlineCapacity;          //!< Indicates the number of bytes available for inline storage.
+
+    /*! Checks if a function object type is stored inline.
+    */
+    template <typename Function>
+    struct stores_inline
+    : std::integral_constant<bool,
+        sizeof(Function) <= InlineCapacity
+        && alignof(Function) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible<Function>::value>
+    {
+    };
+
+
+  public:
+    /*! Constructs an empty task.
+    */
+    basic_unique_task() BOOST_NOEXCEPT
+      : m_operations(0)
+    {
+    }
+
+
+    /*! Constructor. It only participates in overload resolution if the function object can be called without arguments.
+    * \param function The task's function object. It is moved into the task if it is an rvalue.
+    */
+    template <typename Function>
+    basic_unique_task(Function && function,
+                      typename std::enable_if<!std::is_same<typename std::decay<Function>::type, basic_unique_task>::value
+                                              && detail::is_nullary_callable<typename std::decay<Function>::type>::value>::type* = 0)
+      : m_operations(0)
+    {
+      typedef typename std::decay<Function>::type function_type;
+      if(detail::is_null_function(function))
+      {
+        return;
+      }
+      construct<function_type>(std::forward<Function>(function), stores_inline<function_type>());
+    }
+
+
+    /*! Move constructor. The other task is empty afterwards.
+    */
+    basic_unique_task(basic_unique_task && other) BOOST_NOEXCEPT
+      : m_operations(other.m_operations)
+    {
+      if(m_operations)
+      {
+        m_operations->relocate(&m_storage, &other.m_storage);
+        other.m_operations = 0;
+      }
+    }
+
+
+    /*! Move assignment. The other task is empty afterwards.
+    */
+    basic_unique_task & operator=(basic_unique_task && other) BOOST_NOEXCEPT
+    {
+      if(this != &other)
+      {
+        reset();
+        if(other.m_operations)
+        {
+          other.m_operations->relocate(&m_storage, &other.m_storage);
+          m_operations = other.m_operations;
+          other.m_operations = 0;
+        }
+      }
+      return *this;
+    }
+
+
+    basic_unique_task(basic_unique_task const &) = delete;
+    basic_unique_task & operator=(basic_unique_task const &) = delete;
+
+
+    /// Destructor.
+    ~basic_unique_task()
+    {
+      reset();
+    }
+
+
+    /*! Executes the task function. An empty task does nothing.
+    */
+    void operator() (void) const
+    {
+      if(m_operations)
+      {
+        m_operations->invoke(const_cast<storage_type*>(&m_storage));
+      }
+    }
+
+
+    /*! Checks if the task holds no function object.
+    * \return true if the task is empty, false otherwise.
+    */
+    bool empty() const BOOST_NOEXCEPT
+    {
+      return m_operations == 0;
+    }
+
+
+    /*! Checks if the task holds a function object.
+    * \return true if the task is not empty.
+    */
+    explicit operator bool() const BOOST_NOEXCEPT
+    {
+      return m_operations != 0;
+    }
+
+
+    /*! Destroys the function object. The task is empty afterwards.
+    */
+    void reset() BOOST_NOEXCEPT
+    {
+      if(m_operations)
+      {
+        m_operations->destroy(&m_storage);
+        m_operations = 0;
+      }
+    }
+
+
+  private:
+    template <typename FunctionType, typename Function>
+    void construct(Function && function, std::true_type)
+    {
+      ::new(static_cast<void*>(&m_storage)) FunctionType(std::forward<Function>(function));
+      m_operations = inline_operations<FunctionType>::table();
+    }
+
+    template <typename FunctionType, typename Function>
+    void construct(Function && function, std::false_type)
+    {
+      *static_cast<FunctionType**>(static_cast<void*>(&m_storage)) = new FunctionType(std::forward<Function>(function));
+      m_operations = heap_operations<FunctionType>::table();
+    }
+  };
+
+
+  /*! \brief Move-only task function object which stores function objects of up to 48 bytes inline.
+  *
+  * A unique_task occupies 64 bytes, one cache line on common processors.
+  *
+  * \see basic_unique_task
+  */
+  typedef basic_unique_task<48> unique_task;
+
+
+} } // namespace boost::threadpool
+
+#endif // BOOST_NO_CXX11_RVALUE_REFERENCES
+
+#endif // THREADPOOL_UNIQUE_TASK_HPP_INCLUDED
@@ -151,6 +151,7 @@ int main (int argc, char * const argv[])
 
   pool tp;
   tp.size_controller().resize(5);	
+  task_group<pool> merges(tp);
 
 // merge data array
   for(int step = 1; step <= exponent; step++)
@@ -164,10 +165,10 @@ int main (int argc, char * const argv[])
       // sort partition
       boost::shared_ptr<merge_job<image> > job(new merge_job<image>(data, partition*partition_size, partition_size));
       //tp->schedule(prio_task_func(5, boost::bind(&merge_job<image>::run, job)));
-      schedule(tp, boost::bind(&merge_job<image>::run, job));
+      merges.run(boost::bind(&merge_job<image>::run, job));
      // schedule(tp, job);
     }
-    tp.wait();	// wait until all partitions are sorted
+    merges.wait();	// wait until all partitions are sorted
   } 
 
   boost::xtime end;
@@ -0,0 +1,132 @@
+/*! \file
+ * \brief Sort benchmark.
+ *
+ * This example compares parallel_sort with std::sort for 10^5 up to
+ * 10^max_exponent random integers.
+ *
+ * Usage: sort_benchmark [max_exponent [threads]]
+ * The default maximum exponent is 8. Sorting 10^9 integers needs about 8 GB of memory.
+ * The number of threads defaults to the number of processors.
+ *
+ * Copyright (c) 2005-2007 Philipp Henkel
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ * http://threadpool.sourceforge.net
+ *
+ */
+
+
+#include <boost/threadpool.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/xtime.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+using namespace std;
+using namespace boost::threadpool;
+
+
+//
+// Helpers
+unsigned long get_ms_diff(boost::xtime& start, boost::xtime& end)
+{
+  boost::xtime::xtime_sec_t start_ms = start.sec * 1000	+ start.nsec/1000000;
+  boost::xtime::xtime_sec_t end_ms = end.sec * 1000	+ end.nsec/1000000;
+  return static_cast<unsigned long>(end_ms - start_ms);
+}
+
+// fills the data with the same pseudo-random sequence for each run
+void fill_random(vector<int>& data)
+{
+  boost::uint32_t state = 12345;
+  for(size_t i = 0; i < data.size(); i++)
+  {
+    state = state * 1664525u + 1013904223u;
+    data[i] = static_cast<int>(state >> 1);
+  }
+}
+
+bool is_sorted_ascending(vector<int> const & data)
+{
+  for(size_t i = 1; i < data.size(); i++)
+  {
+    if(data[i] < data[i-1])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<class Sort>
+unsigned long measure(vector<int>& data, Sort sort)
+{
+  fill_random(data);
+
+  boost::xtime start;
+  boost::xtime_get(&start, boost::TIME_UTC_);
+  sort(data);
+  boost::xtime end;
+  boost::xtime_get(&end, boost::TIME_UTC_);
+
+  if(!is_sorted_ascending(data))
+  {
+    cout << "array is NOT sorted!" << endl;
+  }
+  return get_ms_diff(start, end);
+}
+
+struct std_sort
+{
+  void operator()(vector<int>& data) const
+  {
+    std::sort(data.begin(), data.end());
+  }
+};
+
+struct pool_sort
+{
+  pool* tp;
+
+  void operator()(vector<int>& data) const
+  {
+    parallel_sort(*tp, data.begin(), data.end());
+  }
+};
+
+
+//
+// Compares parallel_sort with std::sort
+int main (int argc, char * const argv[])
+{
+  int max_exponent = argc > 1 ? atoi(argv[1]) : 8;
+  unsigned int threads = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : boost::thread::hardware_concurrency();
+  if(threads == 0)
+  {
+    threads = 1;
+  }
+
+  pool tp(threads);
+  pool_sort parallel = { &tp };
+
+  cout << "threads: " << threads << endl;
+  cout << "elements\tstd::sort [ms]\tparallel_sort [ms]" << endl;
+
+  size_t size = 100000;
+  for(int exponent = 5; exponent <= max_exponent; exponent++, size *= 10)
+  {
+    vector<int> data(size);
+    unsigned long const std_ms = measure(data, std_sort());
+    unsigned long const parallel_ms = measure(data, parallel);
+    cout << "10^" << exponent << "\t\t" << std_ms << "\t\t" << parallel_ms << endl;
+  }
+
+  return 0;
+}
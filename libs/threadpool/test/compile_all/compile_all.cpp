@@ -16,13 +16,25 @@
 
 
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <sstream>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/bind.hpp>
 
 #include <boost/threadpool.hpp>
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+#include <type_traits>
+#endif
+
 using namespace std;
 using namespace boost::threadpool;
 
@@ -37,6 +49,17 @@ void print(string text)
   cout << text;
 }
 
+int failures = 0;
+
+void check(bool condition, string text)
+{
+  if(!condition)
+  {
+    print("  check failed: " + text + "\n");
+    ++failures;
+  }
+}
+
 template<typename T>
 string to_string(T const & value)
 {
@@ -48,6 +71,62 @@ string to_string(T const & value)
 
 
 
+//
+// A thread-safe scheduler which does not declare concurrent_scheduler_tag
+template <typename Task>
+class locked_fifo_scheduler
+{
+public:
+  typedef Task task_type;
+
+private:
+  mutable boost::mutex m_monitor;
+  std::deque<task_type> m_container;
+
+public:
+  bool push(task_type const & task)
+  {
+    boost::mutex::scoped_lock lock(m_monitor);
+    m_container.push_back(task);
+    return true;
+  }
+
+  bool try_pop(task_type & task)
+  {
+    boost::mutex::scoped_lock lock(m_monitor);
+    if(m_container.empty()) return false;
+    task = m_container.front();
+    m_container.pop_front();
+    return true;
+  }
+
+  size_t size() const
+  {
+    boost::mutex::scoped_lock lock(m_monitor);
+    return m_container.size();
+  }
+
+  bool empty() const
+  {
+    boost::mutex::scoped_lock lock(m_monitor);
+    return m_container.empty();
+  }
+
+  void clear()
+  {
+    boost::mutex::scoped_lock lock(m_monitor);
+    m_container.clear();
+  }
+};
+
+namespace boost { namespace threadpool
+{
+  template <typename Task>
+  struct is_concurrent_scheduler<locked_fifo_scheduler<Task> > : mpl::true_ {};
+} }
+
+
+
 //
 // An example task functions
 void task_1()
@@ -91,12 +170,22 @@ int task_int()
 }
 
 
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+BOOST_STATIC_ASSERT((boost::threadpool::detail::has_variadic_schedule<pool, void (*)(int), int>::value));
+BOOST_STATIC_ASSERT(!(boost::threadpool::detail::has_variadic_schedule<string, void (*)(int), int>::value));
+#endif
+
+
 void fifo_pool_test()
 {
     pool tp;
     
     tp.schedule(&task_1);
     tp.schedule(boost::bind(task_with_parameter, 4));
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    tp.schedule(&task_with_parameter, 4);
+    schedule(tp, &task_with_parameter, 4);
+#endif
 
     if(!tp.empty())
     {
@@ -128,6 +217,729 @@ void prio_pool_test()
     prio_pool tp(2);
     schedule(tp, prio_task_func(1, &task_1));
     schedule(tp, prio_task_func(10,&task_2));
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    tp.emplace(5, &task_3);
+#endif
+}
+
+
+struct print_task
+{
+    print_task() : value(0) {}
+    explicit print_task(int v) : value(v) {}
+    void operator()() const { print("print_task with value " + to_string(value) + "\n"); }
+    int value;
+};
+
+
+void custom_task_pool_test()
+{
+    thread_pool<print_task, fifo_scheduler> tp(2);
+    tp.schedule(print_task(1));
+    tp.schedule(print_task(2));
+    tp.wait();
+}
+
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+struct move_only_task
+{
+    std::unique_ptr<int> value;
+    void operator()() const { print("move_only_task with value " + to_string(*value) + "\n"); }
+};
+
+
+BOOST_STATIC_ASSERT((std::is_constructible<unique_task, move_only_task>::value));
+BOOST_STATIC_ASSERT(!(std::is_constructible<unique_task, int>::value));
+BOOST_STATIC_ASSERT(!(std::is_convertible<string, unique_task>::value));
+
+
+void unique_task_test()
+{
+    pool tp(2);
+    move_only_task task;
+    task.value.reset(new int(7));
+    tp.schedule(std::move(task));
+
+    unique_task deferred(&task_1);
+    schedule(tp, std::move(deferred));
+    tp.wait();
+}
+#endif
+
+
+void bounded_fifo_pool_test()
+{
+    bounded_fifo_pool tp(2);
+    schedule(tp, &task_1);
+    tp.schedule(boost::bind(task_with_parameter, 6));
+    tp.wait();
+}
+
+bool throw_on_copy = false;
+boost::atomic<int> copy_task_count(0);
+
+struct throwing_copy_task
+{
+    throwing_copy_task() {}
+    throwing_copy_task(throwing_copy_task const &) { if(throw_on_copy) throw runtime_error("copy failed"); }
+    void operator()() const { ++copy_task_count; }
+};
+
+void throwing_push_test()
+{
+    thread_pool<task_func, bounded_fifo_scheduler> tp(2);
+    task_func const task = throwing_copy_task();
+
+    throw_on_copy = true;
+    try
+    {
+      tp.schedule(task);
+      check(false, "copying the task throws");
+    }
+    catch(runtime_error const &)
+    {
+    }
+    throw_on_copy = false;
+
+    for(int i = 0; i < 10; ++i)
+    {
+      tp.schedule(task);
+    }
+
+    boost::xtime timeout;
+    boost::xtime_get(&timeout, boost::TIME_UTC_);
+    timeout.sec += 5;
+    check(tp.wait(timeout), "tasks scheduled after a failed push run");
+    check(copy_task_count == 10, "tasks scheduled after a failed push run once");
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    bounded_fifo_pool emplacing_pool(2);
+    throwing_copy_task const function;
+
+    throw_on_copy = true;
+    try
+    {
+      emplacing_pool.emplace(function);
+      check(false, "copying the function throws");
+    }
+    catch(runtime_error const &)
+    {
+    }
+    throw_on_copy = false;
+
+    for(int i = 0; i < 10; ++i)
+    {
+      emplacing_pool.emplace(function);
+    }
+
+    boost::xtime_get(&timeout, boost::TIME_UTC_);
+    timeout.sec += 5;
+    check(emplacing_pool.wait(timeout), "tasks emplaced after a failed emplace run");
+    check(copy_task_count == 20, "tasks emplaced after a failed emplace run once");
+#endif
+}
+
+void work_stealing_pool_test()
+{
+    work_stealing_pool tp(4);
+    schedule(tp, &task_1);
+    tp.schedule(boost::bind(task_with_parameter, 5));
+    tp.wait();
+}
+
+
+class print_request : public intrusive_task_hook
+{
+public:
+    explicit print_request(int v) : value(v) {}
+    void run() { print("print_request with value " + to_string(value) + "\n"); }
+    int value;
+};
+
+
+void intrusive_pool_test()
+{
+    print_request first(1);
+    print_request second(2);
+
+    intrusive_pool tp(2);
+    tp.schedule(first);
+    schedule(tp, intrusive_task(second));
+    tp.wait();
+}
+
+
+void concurrent_scheduler_test()
+{
+    thread_pool<task_func, locked_fifo_scheduler> tp(2);
+    schedule(tp, &task_1);
+    tp.wait();
+}
+
+
+void idle_policy_test()
+{
+    thread_pool<task_func, fifo_scheduler, static_size, resize_controller, wait_for_all_tasks, spin_then_park> tp(2);
+    schedule(tp, &task_1);
+    tp.wait();
+
+    thread_pool<task_func, work_stealing_scheduler, static_size, resize_controller, wait_for_all_tasks, spin_then_park> ws(2);
+    schedule(ws, &task_2);
+    ws.wait();
+
+    thread_pool<task_func, fifo_scheduler, static_size, resize_controller, wait_for_all_tasks, busy_poll> bp;
+    bp.set_worker_cpus(std::vector<unsigned int>(1, 0));
+    bp.size_controller().resize(1);
+    schedule(bp, &task_3);
+    bp.wait();
+    bp.stop();
+}
+
+
+task_func make_parameter_task(size_t index)
+{
+  return boost::bind(task_with_parameter, static_cast<int>(index));
+}
+
+
+void bulk_schedule_test()
+{
+    std::vector<task_func> tasks(3, &task_1);
+
+    fifo_pool tp(2);
+    tp.set_dequeue_batch_size(4);
+    tp.schedule_bulk(tasks.begin(), tasks.end());
+    tp.schedule_n(3, &make_parameter_task);
+    tp.wait();
+
+    work_stealing_pool ws(2);
+    ws.schedule_bulk(tasks.begin(), tasks.end());
+    ws.schedule_n(3, &make_parameter_task);
+    ws.wait();
+}
+
+
+boost::atomic<int> batched_started(0);
+boost::atomic<int> batched_done(0);
+
+void batched_task()
+{
+    ++batched_started;
+    boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+    ++batched_done;
+}
+
+void batched_wait_test()
+{
+    fifo_pool tp(0);
+    tp.set_dequeue_batch_size(8);
+    for(int i = 0; i < 40; ++i)
+    {
+      tp.schedule(&batched_task);
+    }
+    tp.size_controller().resize(2);  // the workers take the tasks in batches
+    tp.wait(5);
+    check(batched_done >= 35, "wait(5) counts the tasks which workers took in batches");
+    tp.wait();
+
+    tp.size_controller().resize(0);
+    for(int i = 0; i < 40; ++i)
+    {
+      tp.schedule(&batched_task);
+    }
+    tp.size_controller().resize(2);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+    tp.clear();
+    check(tp.pending() == 0, "clear() discards the tasks which workers took in batches");
+    tp.wait();
+    check(batched_started < 60, "batched tasks do not start after clear()");
+}
+
+
+void stopped_pool_test()
+{
+    std::vector<task_func> tasks(3, &task_1);
+
+    fifo_pool tp(0);
+    tp.schedule(&task_1);
+    tp.stop();
+    check(!tp.schedule(&task_2), "schedule() fails after stop()");
+    check(tp.schedule_bulk(tasks.begin(), tasks.end()) == 0, "schedule_bulk() fails after stop()");
+    check(tp.pending() == 0, "no tasks are pending after stop()");
+
+    boost::xtime timeout;
+    boost::xtime_get(&timeout, boost::TIME_UTC_);
+    timeout.sec += 5;
+    check(tp.wait(timeout), "wait() does not wait for tasks after stop()");
+
+    bounded_fifo_pool bp(2);
+    bp.stop();
+    check(!bp.schedule(&task_2), "schedule() on a concurrent scheduler fails after stop()");
+    check(bp.schedule_n(3, &make_parameter_task) == 0, "schedule_n() fails after stop()");
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    check(!bp.emplace(&task_3), "emplace() fails after stop()");
+#endif
+    check(bp.pending() == 0, "no tasks are pending in a concurrent scheduler after stop()");
+    bp.wait();
+}
+
+
+fifo_pool* nested_pool = 0;
+
+int nested_future_task()
+{
+  future<int> fut = schedule(*nested_pool, &task_4);
+  nested_pool->wait(1);
+  return fut.get();
+}
+
+
+void helping_wait_test()
+{
+    fifo_pool tp(1);
+    nested_pool = &tp;
+    future<int> fut = schedule(tp, &nested_future_task);
+    check(fut.get() == 4, "helping wait returns the nested task's result");
+    tp.wait();
+}
+
+
+boost::atomic<bool> long_task_started(false);
+boost::atomic<bool> long_task_done(false);
+boost::atomic<bool> nested_wait_saw_long_task(false);
+
+void long_task()
+{
+  long_task_started = true;
+  boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+  long_task_done = true;
+}
+
+void inner_waiting_task()
+{
+  nested_pool->wait();
+  nested_wait_saw_long_task = long_task_done.load();
+}
+
+void outer_waiting_task()
+{
+  nested_pool->schedule(&inner_waiting_task);
+  nested_pool->wait();  // executes inner_waiting_task, which waits again
+}
+
+
+void nested_helping_wait_test()
+{
+    fifo_pool tp(2);
+    nested_pool = &tp;
+    tp.schedule(&long_task);
+    while(!long_task_started)
+    {
+      boost::this_thread::yield();
+    }
+    tp.schedule(&outer_waiting_task);
+    tp.wait();
+    check(nested_wait_saw_long_task, "a nested helping wait waits for the tasks of other workers");
+}
+
+
+void task_group_test()
+{
+    fifo_pool tp(2);
+    task_group<fifo_pool> group(tp);
+    group.run(&task_1);
+    group.run(boost::bind(task_with_parameter, 6));
+    group.wait();
+
+    group.cancel();
+    group.run(&task_2);
+    group.wait();
+
+    work_stealing_pool ws(2);
+    task_group<work_stealing_pool> ws_group(ws);
+    ws_group.run(&task_3);
+    ws_group.wait();
+}
+
+
+void fork_join_test()
+{
+    work_stealing_pool tp(2);
+    parallel_invoke(tp, &task_1, &task_2);
+    parallel_invoke(tp, &task_1, &task_2, &task_3, boost::bind(task_with_parameter, 7), &task_1);
+
+    fork_join<work_stealing_pool> scope(tp);
+    scope.spawn(&task_1);
+    scope.spawn(&task_2);
+    scope.sync();
+}
+
+
+struct count_body
+{
+  int* data;
+
+  void operator()(index_range<> const & range) const
+  {
+    for(size_t i = range.begin(); i != range.end(); ++i)
+    {
+      ++data[i];
+    }
+  }
+};
+
+
+bool all_equal(std::vector<int> const & data, int value)
+{
+  return std::count(data.begin(), data.end(), value) == static_cast<std::ptrdiff_t>(data.size());
+}
+
+
+void parallel_for_test()
+{
+    std::vector<int> data(1000);
+    count_body body = { &data[0] };
+
+    fifo_pool tp(2);
+    index_range<> range(0, data.size(), cache_line_elements<int>());
+    parallel_for(tp, range, body);
+    check(all_equal(data, 1), "parallel_for visits each index once");
+    parallel_for(tp, range, body, static_partitioner());
+    check(all_equal(data, 2), "parallel_for with static_partitioner visits each index once");
+    parallel_for(tp, range, body, simple_partitioner(100));
+    check(all_equal(data, 3), "parallel_for with simple_partitioner visits each index once");
+    parallel_for(tp, range, body, adaptive_partitioner(16));
+    check(all_equal(data, 4), "parallel_for with adaptive_partitioner visits each index once");
+}
+
+
+struct sum_body
+{
+  int const* data;
+
+  int operator()(index_range<> const & range, int init) const
+  {
+    for(size_t i = range.begin(); i != range.end(); ++i)
+    {
+      init += data[i];
+    }
+    return init;
+  }
+};
+
+
+int square(int value)
+{
+  return value * value;
+}
+
+
+struct concat_body
+{
+  char const* data;
+
+  string operator()(index_range<> const & range, string init) const
+  {
+    for(size_t i = range.begin(); i != range.end(); ++i)
+    {
+      init += data[i];
+    }
+    return init;
+  }
+};
+
+
+void parallel_reduce_test()
+{
+    std::vector<int> data(1000, 1);
+    sum_body body = { &data[0] };
+
+    work_stealing_pool tp(2);
+    int sum = parallel_reduce(tp, index_range<>(0, data.size()), 0, body, std::plus<int>());
+    check(sum == 1000, "parallel_reduce sums all elements");
+    sum = parallel_reduce(tp, index_range<>(0, data.size()), 0, body, std::plus<int>(), static_partitioner());
+    check(sum == 1000, "parallel_reduce with static_partitioner sums all elements");
+    sum = parallel_transform_reduce(tp, data.begin(), data.end(), 0, std::plus<int>(), &square);
+    check(sum == 1000, "parallel_transform_reduce sums all elements");
+    sum = parallel_transform_reduce(tp, data.begin(), data.end(), 0, std::plus<int>(), &square, simple_partitioner(64));
+    check(sum == 1000, "parallel_transform_reduce with simple_partitioner sums all elements");
+
+    // concatenation is not commutative, the chunks must be combined in order
+    std::vector<char> letters;
+    for(int i = 0; i < 1000; ++i)
+    {
+      letters.push_back(static_cast<char>('a' + i % 26));
+    }
+    string const expected(letters.begin(), letters.end());
+    concat_body concat = { &letters[0] };
+    index_range<> const range(0, letters.size());
+
+    check(parallel_reduce(tp, range, string(), concat, std::plus<string>()) == expected,
+      "parallel_reduce combines the chunks in order");
+    check(parallel_reduce(tp, range, string(), concat, std::plus<string>(), static_partitioner()) == expected,
+      "parallel_reduce with static_partitioner combines the chunks in order");
+    check(parallel_reduce(tp, range, string(), concat, std::plus<string>(), simple_partitioner(7)) == expected,
+      "parallel_reduce with simple_partitioner combines the chunks in order");
+}
+
+
+template <typename Iterator, typename Compare>
+bool sorted(Iterator first, Iterator last, Compare comp)
+{
+  for(Iterator next = first; first != last && ++next != last; ++first)
+  {
+    if(comp(*next, *first))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+struct keyed_value
+{
+  int key;
+  int index;  // position before the sort
+};
+
+bool key_less(keyed_value const & a, keyed_value const & b)
+{
+  return a.key < b.key;
+}
+
+bool key_index_less(keyed_value const & a, keyed_value const & b)
+{
+  return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+
+
+void parallel_sort_test()
+{
+    std::vector<int> data;
+    for(int i = 0; i < 10000; ++i)
+    {
+      data.push_back((i * 7919) % 1000);
+    }
+
+    work_stealing_pool tp(2);
+    parallel_sort(tp, data.begin(), data.end());
+    check(sorted(data.begin(), data.end(), std::less<int>()), "parallel_sort sorts in ascending order");
+    parallel_sort(tp, data.begin(), data.end(), std::greater<int>());
+    check(sorted(data.begin(), data.end(), std::greater<int>()), "parallel_sort sorts by the comparison");
+
+    // equal keys keep their original order
+    std::vector<keyed_value> values;
+    for(int i = 0; i < 10000; ++i)
+    {
+      keyed_value const value = { (i * 7919) % 100, i };
+      values.push_back(value);
+    }
+    parallel_sort(tp, values.begin(), values.end(), &key_less);
+    check(sorted(values.begin(), values.end(), &key_index_less), "parallel_sort is stable");
+}
+
+
+void parallel_scan_test()
+{
+    std::vector<int> data;
+    for(int i = 0; i < 50000; ++i)  // several scan blocks
+    {
+      data.push_back(i % 7 + 1);
+    }
+    std::vector<int> inclusive(data.size());
+    std::partial_sum(data.begin(), data.end(), inclusive.begin());
+    std::vector<int> exclusive(1, 0);
+    exclusive.insert(exclusive.end(), inclusive.begin(), inclusive.end() - 1);
+
+    std::vector<int> sums(data.size());
+
+    fifo_pool tp(2);
+    parallel_inclusive_scan(tp, data.begin(), data.end(), sums.begin());
+    check(sums == inclusive, "parallel_inclusive_scan matches the serial scan");
+    std::fill(sums.begin(), sums.end(), 0);
+    parallel_inclusive_scan(tp, data.begin(), data.end(), sums.begin(), std::plus<int>());
+    check(sums == inclusive, "parallel_inclusive_scan with an operation matches the serial scan");
+    parallel_exclusive_scan(tp, data.begin(), data.end(), sums.begin(), 0);
+    check(sums == exclusive, "parallel_exclusive_scan matches the serial scan");
+    parallel_exclusive_scan(tp, data.begin(), data.end(), data.begin(), 0, std::plus<int>());
+    check(data == exclusive, "parallel_exclusive_scan in place matches the serial scan");
+}
+
+
+boost::atomic<int> items_in_flight(0);
+boost::atomic<int> max_items_in_flight(0);
+
+class counting_input : public pipeline_stage
+{
+  std::vector<int> m_values;
+  size_t m_next;
+
+public:
+  explicit counting_input(size_t count)
+    : pipeline_stage(serial_in_order)
+    , m_values(count)
+    , m_next(0)
+  {
+  }
+
+  void* operator()(void*)
+  {
+    if(m_next == m_values.size())
+    {
+      return 0;
+    }
+
+    int const in_flight = ++items_in_flight;
+    int max_in_flight = max_items_in_flight.load();
+    while(in_flight > max_in_flight && !max_items_in_flight.compare_exchange_weak(max_in_flight, in_flight))
+    {
+    }
+
+    m_values[m_next] = static_cast<int>(m_next);
+    return &m_values[m_next++];
+  }
+};
+
+
+class doubling_stage : public pipeline_stage
+{
+public:
+  doubling_stage()
+    : pipeline_stage(parallel)
+  {
+  }
+
+  void* operator()(void* item)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));  // keeps several items in flight
+    *static_cast<int*>(item) *= 2;
+    return item;
+  }
+};
+
+
+class counting_stage : public pipeline_stage
+{
+public:
+  counting_stage()
+    : pipeline_stage(serial_out_of_order)
+    , count(0)
+  {
+  }
+
+  void* operator()(void* item)
+  {
+    ++count;
+    return item;
+  }
+
+  int count;
+};
+
+
+class recording_stage : public pipeline_stage
+{
+public:
+  recording_stage()
+    : pipeline_stage(serial_in_order)
+  {
+  }
+
+  void* operator()(void* item)
+  {
+    values.push_back(*static_cast<int*>(item));
+    --items_in_flight;
+    return item;
+  }
+
+  std::vector<int> values;
+};
+
+
+void pipeline_test()
+{
+    counting_input input(100);
+    doubling_stage doubling;
+    counting_stage unordered;
+    recording_stage ordered;
+
+    pipeline stages;
+    stages.add_stage(input);
+    stages.add_stage(doubling);
+    stages.add_stage(unordered);
+    stages.add_stage(ordered);
+
+    fifo_pool tp(4);
+    parallel_pipeline(tp, 4, stages);
+
+    check(unordered.count == 100, "each item passes the serial_out_of_order stage once");
+    bool in_order = ordered.values.size() == 100;
+    for(size_t i = 0; in_order && i < ordered.values.size(); ++i)
+    {
+      in_order = ordered.values[i] == static_cast<int>(2 * i);
+    }
+    check(in_order, "the serial_in_order stage receives the items in input order");
+    check(max_items_in_flight <= 4, "no more than max_tokens items are in flight");
+}
+
+
+boost::atomic<int> graph_clock(0);
+boost::atomic<int> graph_started[3];   // when each node started, 0 if it did not run
+boost::atomic<int> graph_finished[3];
+
+void graph_node(int node)
+{
+  graph_started[node] = ++graph_clock;
+  print("  graph node " + to_string(node) + "\n");
+  graph_finished[node] = ++graph_clock;
+}
+
+void reset_graph_clock()
+{
+  graph_clock = 0;
+  for(int i = 0; i < 3; ++i)
+  {
+    graph_started[i] = 0;
+    graph_finished[i] = 0;
+  }
+}
+
+bool last_ran_after_first_and_second()
+{
+  return graph_finished[0] > 0 && graph_finished[1] > 0
+    && graph_started[2] > graph_finished[0] && graph_started[2] > graph_finished[1];
+}
+
+
+void task_graph_test()
+{
+    task_graph graph;
+    task_graph::node_id const first = graph.add_node(boost::bind(graph_node, 0));
+    task_graph::node_id const second = graph.add_node(boost::bind(graph_node, 1), 5);
+    task_graph::node_id const last = graph.add_node(boost::bind(graph_node, 2));
+    graph.add_edge(first, last);
+    graph.add_edge(second, last);
+
+    fifo_pool tp(2);
+    reset_graph_clock();
+    check(graph.run(tp), "task_graph runs");
+    check(last_ran_after_first_and_second(), "task_graph runs a node after its predecessors");
+
+    prio_pool ptp(2);
+    reset_graph_clock();
+    check(graph.run(ptp, task_graph::critical_path_first), "task_graph runs critical path first");
+    check(last_ran_after_first_and_second(), "task_graph runs a node after its predecessors critical path first");
+
+    captured_task_graph<fifo_pool> captured(tp);
+    check(captured.capture(graph, task_graph::critical_path_first), "captured_task_graph captures the graph");
+    for(int i = 0; i < 3; ++i)
+    {
+      reset_graph_clock();
+      captured.run();
+      check(last_ran_after_first_and_second(), "captured_task_graph runs a node after its predecessors on every run");
+    }
 }
 
 
@@ -144,6 +956,29 @@ int main (int , char * const [])
   fifo_pool_test();
   lifo_pool_test();
   prio_pool_test();
+  custom_task_pool_test();
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  unique_task_test();
+#endif
+  bounded_fifo_pool_test();
+  throwing_push_test();
+  work_stealing_pool_test();
+  intrusive_pool_test();
+  concurrent_scheduler_test();
+  bulk_schedule_test();
+  batched_wait_test();
+  stopped_pool_test();
+  idle_policy_test();
   future_test();
-  return 0;
+  helping_wait_test();
+  nested_helping_wait_test();
+  task_group_test();
+  fork_join_test();
+  parallel_for_test();
+  parallel_reduce_test();
+  parallel_sort_test();
+  parallel_scan_test();
+  pipeline_test();
+  task_graph_test();
+  return failures == 0 ? 0 : 1;
 }